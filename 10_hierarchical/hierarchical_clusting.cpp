@@ -8,6 +8,7 @@
 #include <cmath>
 #include <limits>
 #include <cctype>
+#include "../common/csv_loader.h"
 using namespace std;
 
 vector<vector<double>> dataset;
@@ -24,52 +25,34 @@ double euclideanDistance(const vector<double> &a, const vector<double> &b)
   return sqrt(sum);
 }
 
-void loadSingleColumnData(const string &filename)
+void loadSingleColumnData(const CSVTable &table)
 {
-  ifstream file(filename);
-  string line;
-
   // Skip header line
-  if (!getline(file, line))
+  if (table.columns() == 0)
   {
     cerr << "Error: Empty file or cannot read header" << endl;
     return;
   }
 
-  cout << "Header: " << line << endl;
+  cout << "Header: " << table.headerText(0) << "," << table.headerText(1) << endl;
 
-  while (getline(file, line))
+  for (size_t r = 0; r < table.rows(); r++)
   {
-    // Skip empty lines
-    if (line.empty())
-      continue;
-
-    stringstream ss(line);
-    string name;
-    string valueStr;
-    double value;
-
-    // Read name (first column)
-    if (!getline(ss, name, ','))
-    {
-      cerr << "Error: Cannot read name from line: " << line << endl;
-      continue;
-    }
+    string name = table.cellText(r, 0);
 
     // Read value (second column)
-    if (!getline(ss, valueStr))
+    if (table.width(r) < 2)
     {
-      cerr << "Error: Cannot read value from line: " << line << endl;
+      cerr << "Error: Cannot read value from row " << r + 1 << endl;
       continue;
     }
 
     // Trim whitespace from value string
-    valueStr.erase(0, valueStr.find_first_not_of(" \t"));
-    valueStr.erase(valueStr.find_last_not_of(" \t") + 1);
+    string valueStr(trimView(table.cell(r, 1)));
 
     try
     {
-      value = stod(valueStr);
+      double value = stod(valueStr);
       pointNames.push_back(name);
       dataset.push_back({value});
       cout << "Loaded: " << name << " = " << value << endl;
@@ -79,55 +62,30 @@ void loadSingleColumnData(const string &filename)
       cerr << "Error converting value '" << valueStr << "' to double: " << e.what() << endl;
     }
   }
-  file.close();
 }
 
-void loadMultiColumnData(const string &filename)
+void loadMultiColumnData(const CSVTable &table)
 {
-  ifstream file(filename);
-  string line;
-
-  // Read and parse header
-  if (!getline(file, line))
+  if (table.columns() == 0)
   {
     cerr << "Error: Empty file" << endl;
     return;
   }
 
-  stringstream ss(line);
-  string header;
-  vector<string> headers;
-
-  while (getline(ss, header, ','))
-  {
-    headers.push_back(header);
-  }
-
-  cout << "Found " << headers.size() - 1 << " data columns" << endl;
+  cout << "Found " << table.columns() - 1 << " data columns" << endl;
 
   // Read data rows
-  while (getline(file, line))
+  for (size_t r = 0; r < table.rows(); r++)
   {
-    if (line.empty())
-      continue;
-
-    stringstream ss(line);
     vector<double> row;
-    string value;
-    string name;
 
     // First column is the name
-    if (!getline(ss, name, ','))
-    {
-      cerr << "Error: Cannot read name from line: " << line << endl;
-      continue;
-    }
-
-    pointNames.push_back(name);
+    pointNames.push_back(table.cellText(r, 0));
 
     // Read data values
-    while (getline(ss, value, ','))
+    for (size_t c = 1; c < table.width(r); c++)
     {
+      string value(table.cell(r, c));
       if (!value.empty())
       {
         try
@@ -143,7 +101,6 @@ void loadMultiColumnData(const string &filename)
     }
     dataset.push_back(row);
   }
-  file.close();
 }
 
 vector<vector<double>> computeDistanceMatrix()
@@ -163,29 +120,10 @@ vector<vector<double>> computeDistanceMatrix()
   return distMatrix;
 }
 
-bool isSingleColumnData(const string &filename)
+bool isSingleColumnData(const CSVTable &table)
 {
-  ifstream file(filename);
-  string line;
-
-  if (!getline(file, line))
-  {
-    cerr << "Error: Cannot read file" << endl;
-    return false;
-  }
-
-  stringstream ss(line);
-  string token;
-  int count = 0;
-  while (getline(ss, token, ','))
-  {
-    count++;
-  }
-
-  file.close();
-
-  cout << "Column count in header: " << count << endl;
-  return count == 2;
+  cout << "Column count in header: " << table.columns() << endl;
+  return table.columns() == 2;
 }
 
 string mergeClusters(const string &a, const string &b)
@@ -363,19 +301,27 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  CSVTable table;
+  if (!table.load(filename))
+  {
+    cerr << "Error: Cannot read file" << endl;
+    return 1;
+  }
+  table.printLoadStats();
+
   vector<vector<double>> distanceMatrix;
 
-  if (isSingleColumnData(filename))
+  if (isSingleColumnData(table))
   {
     cout << "Loading single-column data from: " << filename << endl;
-    loadSingleColumnData(filename);
+    loadSingleColumnData(table);
     cout << "Computing distance matrix from 1D data..." << endl;
     distanceMatrix = computeDistanceMatrix();
   }
   else
   {
     cout << "Loading multi-dimensional data from: " << filename << endl;
-    loadMultiColumnData(filename);
+    loadMultiColumnData(table);
     cout << "Computing distance matrix..." << endl;
     distanceMatrix = computeDistanceMatrix();
   }
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <map>
 #include <iomanip>
+#include "../common/column_cache.h"
+#include "../common/cli_flags.h"
+#include "../common/csv_writer.h"
 using namespace std;
 
 struct Point
@@ -20,48 +23,24 @@ vector<vector<double>> distanceMatrix;
 double eps;
 int minPts;
 
-vector<Point> loadData(const string &filename, const vector<int> &selectedCols)
+vector<Point> loadData(const ColumnCache &table, const vector<int> &selectedCols)
 {
-  ifstream file(filename);
   vector<Point> data;
-  string line;
-
-  if (!file.is_open())
-  {
-    cerr << "Error: Cannot open file " << filename << endl;
-    return data;
-  }
-
-  getline(file, line);
+  vector<ColumnParseStats> stats(selectedCols.size());
 
   int index = 0;
-  while (getline(file, line))
+  for (size_t r = 0; r < table.rows(); r++)
   {
-    if (line.empty())
-      continue;
-    stringstream ss(line);
-    string cell;
-    vector<string> row;
-
-    while (getline(ss, cell, ','))
-    {
-      row.push_back(cell);
-    }
-
     vector<double> values;
-    for (int colIdx : selectedCols)
+    for (size_t i = 0; i < selectedCols.size(); i++)
     {
-      if (colIdx < (int)row.size())
+      int colIdx = selectedCols[i];
+      if (colIdx >= 0 && colIdx < (int)table.columns() && table.present(r, colIdx))
       {
-        try
-        {
-          values.push_back(stod(row[colIdx]));
-        }
-        catch (...)
-        {
-          cerr << "Warning: Invalid number -> " << row[colIdx] << endl;
-          values.push_back(0.0);
-        }
+        double value;
+        if (stats[i].record(table.number(r, colIdx, value)) != ParseStatus::Ok)
+          value = 0.0;
+        values.push_back(value);
       }
     }
 
@@ -72,6 +51,10 @@ vector<Point> loadData(const string &filename, const vector<int> &selectedCols)
     }
   }
 
+  vector<string> names;
+  for (int colIdx : selectedCols)
+    names.push_back(colIdx >= 0 && colIdx < (int)table.columns() ? table.header(colIdx) : "?");
+  printParseStats(names, stats);
   return data;
 }
 
@@ -262,20 +245,23 @@ void printResults(const vector<int> &cluster, const vector<string> &pointType)
 
 void saveResults(const vector<int> &cluster, const vector<string> &pointType, const string &filename)
 {
-  ofstream out(filename);
-  out << "Point,Cluster,Type\n";
+  CSVWriter out;
+  out.open(filename);
+  out.text("Point,Cluster,Type\n");
   for (int i = 0; i < dataset.size(); i++)
   {
-    out << "P" << i << ",";
+    out.cell("P");
+    out.text(i);
     if (cluster[i] == -1)
     {
-      out << "Noise";
+      out.cell("Noise");
     }
     else
     {
-      out << cluster[i];
+      out.cell(cluster[i]);
     }
-    out << "," << pointType[i] << "\n";
+    out.cell(pointType[i]);
+    out.endRow();
   }
   out.close();
   cout << "Saved results to: " << filename << "\n";
@@ -283,26 +269,26 @@ void saveResults(const vector<int> &cluster, const vector<string> &pointType, co
 
 int main(int argc, char *argv[])
 {
-  if (argc != 2)
+  int threads = takeThreadsFlag(argc, argv);
+  string na;
+  if (takeFlag(argc, argv, "--na", na))
+    naTokens().set(na);
+  if (argc != 2 || threads < 1)
   {
-    cerr << "Usage: " << argv[0] << " <data.csv>\n";
+    cerr << "Usage: " << argv[0] << " <data.csv> [--threads N] [--na TOKEN,TOKEN...]\n";
     return 1;
   }
 
   string file = argv[1];
-  
-  ifstream testFile(file);
-  string headerLine;
-  getline(testFile, headerLine);
-  testFile.close();
-  
-  stringstream ss(headerLine);
-  string col;
-  vector<string> columns;
-  while (getline(ss, col, ','))
+  ColumnCache table;
+  if (!table.open(file, threads))
   {
-    columns.push_back(col);
+    cerr << "Error: Cannot open file " << file << endl;
+    return 1;
   }
+  table.printLoadStats();
+
+  vector<string> columns = table.headerNames();
   
   cout << "Available columns:\n";
   for (size_t i = 0; i < columns.size(); i++)
@@ -331,7 +317,7 @@ int main(int argc, char *argv[])
     }
   }
   
-  dataset = loadData(file, selectedCols);
+  dataset = loadData(table, selectedCols);
   if (dataset.empty())
   {
     cerr << "No valid data found.\n";
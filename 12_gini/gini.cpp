@@ -2,34 +2,34 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
-#include <map>
 #include <cmath>
 #include <iomanip>
+#include "../common/categorical.h"
 using namespace std;
 
-double entropy(map<string, int> &freq)
+double entropy(const int *freq, size_t n)
 {
   double total = 0, e = 0;
-  for (auto &f : freq)
-    total += f.second;
-  for (auto &f : freq)
+  for (size_t i = 0; i < n; i++)
+    total += freq[i];
+  for (size_t i = 0; i < n; i++)
   {
-    if (f.second == 0)
+    if (freq[i] == 0)
       continue;
-    double p = f.second / total;
+    double p = freq[i] / total;
     e -= p * log2(p);
   }
   return e;
 }
 
-double gini(map<string, int> &freq)
+double gini(const int *freq, size_t n)
 {
   double total = 0, g = 1;
-  for (auto &f : freq)
-    total += f.second;
-  for (auto &f : freq)
+  for (size_t i = 0; i < n; i++)
+    total += freq[i];
+  for (size_t i = 0; i < n; i++)
   {
-    double p = f.second / total;
+    double p = freq[i] / total;
     g -= p * p;
   }
   return g;
@@ -43,34 +43,17 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  ifstream fin(argv[1]);
-  if (!fin.is_open())
+  CSVTable table;
+  if (!table.load(argv[1]))
   {
     cout << "Error opening file.\n";
     return 1;
   }
 
-  string header;
-  getline(fin, header);
-  vector<string> headers;
-  stringstream hs(header);
-  string tmp;
-  while (getline(hs, tmp, ','))
-    headers.push_back(tmp);
-
-  vector<vector<string>> data;
-  while (getline(fin, tmp))
-  {
-    if (tmp.empty())
-      continue;
-    stringstream ss(tmp);
-    vector<string> row;
-    string val;
-    while (getline(ss, val, ','))
-      row.push_back(val);
-    data.push_back(row);
-  }
-  fin.close();
+  vector<string> headers = table.headerNames();
+  vector<CategoricalColumn> data = loadCategorical(table);
+  size_t rows = table.rows();
+  table.printLoadStats();
 
   cout << "\nAvailable columns:\n";
   for (int i = 0; i < headers.size(); i++)
@@ -94,14 +77,13 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  vector<string> classLabels;
-  for (auto &r : data)
-    classLabels.push_back(r[classCol - 1]);
-  map<string, int> parentFreq;
-  for (auto &c : classLabels)
+  const vector<uint32_t> &classLabels = data[classCol - 1].codes;
+  size_t classes = data[classCol - 1].levels();
+  vector<int> parentFreq(classes, 0);
+  for (uint32_t c : classLabels)
     parentFreq[c]++;
-  double parentEntropy = entropy(parentFreq);
-  double parentGini = gini(parentFreq);
+  double parentEntropy = entropy(parentFreq.data(), classes);
+  double parentGini = gini(parentFreq.data(), classes);
 
   cout << "\nParent Entropy: " << parentEntropy << "\n";
   cout << "Parent Gini: " << parentGini << "\n\n";
@@ -118,19 +100,21 @@ int main(int argc, char *argv[])
     if (c + 1 == classCol)
       continue;
 
-    map<string, map<string, int>> freq;
-    for (int i = 0; i < data.size(); i++)
-      freq[data[i][c]][classLabels[i]]++;
+    size_t levels = data[c].levels();
+    vector<int> freq(levels * classes, 0);
+    for (size_t i = 0; i < rows; i++)
+      freq[data[c].codes[i] * classes + classLabels[i]]++;
 
-    double total = data.size();
+    double total = rows;
     double weightedEntropy = 0, weightedGini = 0;
-    for (auto &kv : freq)
+    for (size_t v = 0; v < levels; v++)
     {
+      const int *counts = freq.data() + v * classes;
       double subset = 0;
-      for (auto &x : kv.second)
-        subset += x.second;
-      weightedEntropy += (subset / total) * entropy(kv.second);
-      weightedGini += (subset / total) * gini(kv.second);
+      for (size_t k = 0; k < classes; k++)
+        subset += counts[k];
+      weightedEntropy += (subset / total) * entropy(counts, classes);
+      weightedGini += (subset / total) * gini(counts, classes);
     }
 
     double gain = parentEntropy - weightedEntropy;
@@ -5,101 +5,64 @@
 #include <map>
 #include <algorithm>
 #include <cmath>
+#include "../common/schema.h"
 using namespace std;
 
-vector<vector<string>> dataset;
+CSVTable table;
+Schema schema;
+TypedTable dataset;
 vector<string> headers;
+size_t rows = 0;
 
 void loadData(const string &filename)
 {
-  ifstream file(filename);
-  string line;
+  if (!table.load(filename))
+    return;
 
-  getline(file, line);
-  stringstream ss(line);
-  string header;
-  while (getline(ss, header, ','))
-  {
-    headers.push_back(header);
-  }
-
-  while (getline(file, line))
-  {
-    stringstream ss(line);
-    vector<string> row;
-    string value;
-    while (getline(ss, value, ','))
-    {
-      row.push_back(value);
-    }
-    dataset.push_back(row);
-  }
-  file.close();
+  headers = table.headerNames();
+  schema = inferSchema(table);
+  table.printLoadStats();
 }
 
-double getPrior(const string &targetClass, int targetCol)
+vector<int> countLevels(int col)
 {
-  int count = 0;
-  for (auto &row : dataset)
-  {
-    if (row[targetCol] == targetClass)
-      count++;
-  }
-  return (double)count / dataset.size();
+  vector<int> counts(dataset.categories(col).levels(), 0);
+  for (uint32_t code : dataset.categories(col).codes)
+    counts[code]++;
+  return counts;
 }
 
-bool isNumeric(const string &str)
+vector<int> countPairs(int attrCol, int targetCol)
 {
-  try
-  {
-    stod(str);
-    return true;
-  }
-  catch (...)
-  {
-    return false;
-  }
+  const CategoricalColumn &attr = dataset.categories(attrCol), &target = dataset.categories(targetCol);
+  size_t classes = target.levels();
+  vector<int> counts(attr.levels() * classes, 0);
+  for (size_t r = 0; r < rows; r++)
+    counts[attr.codes[r] * classes + target.codes[r]]++;
+  return counts;
 }
 
-double getConditional(const string &attr, const string &val, const string &targetClass, int attrCol, int targetCol)
+double getConditional(const vector<int> &pairCounts, const vector<int> &classCount, uint32_t val, uint32_t targetClass)
 {
-  int total = 0, count = 0;
-
-  for (auto &row : dataset)
-  {
-    if (row[targetCol] == targetClass)
-    {
-      total++;
-      if (row[attrCol] == val)
-        count++;
-    }
-  }
-
+  int total = classCount[targetClass];
   if (total == 0)
   {
     return 0;
   }
 
+  int count = val == Dictionary::npos ? 0 : pairCounts[val * classCount.size() + targetClass];
   return (double)count / total;
 }
 
-double getGaussianProbability(double value, const string &targetClass, int attrCol, int targetCol)
+double getGaussianProbability(double value, uint32_t targetClass, int attrCol, int targetCol)
 {
   vector<double> values;
-  
-  for (auto &row : dataset)
+  const vector<uint32_t> &classes = dataset.categories(targetCol).codes;
+  for (size_t r = 0; r < rows; r++)
   {
-    if (row[targetCol] == targetClass)
-    {
-      try
-      {
-        values.push_back(stod(row[attrCol]));
-      }
-      catch (...)
-      {
-        continue;
-      }
-    }
+    double v;
+    if (classes[r] == targetClass && dataset.number(r, attrCol, v) == ParseStatus::Ok)
+      values.push_back(v);
   }
   
   if (values.empty())
@@ -134,7 +97,7 @@ int main(int argc, char *argv[])
   loadData(argv[1]);
 
   cout << "Available columns:\n";
-  for (int i = 0; i < headers.size(); i++)
+  for (size_t i = 0; i < headers.size(); i++)
   {
     cout << i + 1 << ". " << headers[i] << "\n";
   }
@@ -148,23 +111,27 @@ int main(int argc, char *argv[])
     targetCol = stoi(input) - 1;
   else
   {
-    for (int i = 0; i < headers.size(); i++)
+    for (size_t i = 0; i < headers.size(); i++)
     {
       if (headers[i] == input)
         targetCol = i;
     }
   }
 
-  if (targetCol < 0 || targetCol >= headers.size())
+  if (targetCol < 0 || targetCol >= (int)headers.size())
   {
     cout << "Invalid target column.\n";
     return 1;
   }
 
+  schema.columns[targetCol].type = ColumnType::Categorical;
+  dataset.load(table, schema);
+  rows = dataset.rows();
+
   vector<string> featureCols;
-  for (int i = 0; i < headers.size(); i++)
+  for (size_t i = 0; i < headers.size(); i++)
   {
-    if (i != targetCol)
+    if ((int)i != targetCol)
       featureCols.push_back(headers[i]);
   }
 
@@ -174,21 +141,13 @@ int main(int argc, char *argv[])
   for (auto &feature : featureCols)
   {
     int featureCol = -1;
-    for (int i = 0; i < headers.size(); i++)
+    for (size_t i = 0; i < headers.size(); i++)
     {
       if (headers[i] == feature)
         featureCol = i;
     }
     
-    bool numeric = true;
-    for (int i = 0; i < min(5, (int)dataset.size()); i++)
-    {
-      if (!isNumeric(dataset[i][featureCol]))
-      {
-        numeric = false;
-        break;
-      }
-    }
+    bool numeric = dataset.numeric(featureCol);
     isNumericFeature[feature] = numeric;
     
     cout << "Enter value for " << feature;
@@ -201,27 +160,36 @@ int main(int argc, char *argv[])
     testData[feature] = input;
   }
 
-  map<string, int> classCount;
-  for (auto &row : dataset)
-  {
-    classCount[row[targetCol]]++;
-  }
+  vector<int> classCount = countLevels(targetCol);
+  const Dictionary &classes = dataset.categories(targetCol).dict;
 
   ofstream fout("output.csv");
   fout << "Class,Probability\n";
 
+  map<string, vector<int>> pairCounts;
+  for (auto &feature : featureCols)
+  {
+    int attrCol = -1;
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+      if (headers[i] == feature)
+        attrCol = i;
+    }
+    if (!isNumericFeature[feature])
+      pairCounts[feature] = countPairs(attrCol, targetCol);
+  }
+
   double totalProb = 0;
-  map<string, double> classProbabilities;
+  vector<double> classProbabilities(classes.size());
 
-  for (auto &cls : classCount)
+  for (uint32_t cls = 0; cls < classes.size(); cls++)
   {
-    string className = cls.first;
-    double probability = getPrior(className, targetCol);
+    double probability = (double)classCount[cls] / rows;
 
     for (auto &feature : featureCols)
     {
       int attrCol = -1;
-      for (int i = 0; i < headers.size(); i++)
+      for (size_t i = 0; i < headers.size(); i++)
       {
         if (headers[i] == feature)
           attrCol = i;
@@ -230,30 +198,31 @@ int main(int argc, char *argv[])
       if (isNumericFeature[feature])
       {
         double value = stod(testData[feature]);
-        probability *= getGaussianProbability(value, className, attrCol, targetCol);
+        probability *= getGaussianProbability(value, cls, attrCol, targetCol);
       }
       else
       {
-        probability *= getConditional(feature, testData[feature], className, attrCol, targetCol);
+        uint32_t val = dataset.categories(attrCol).dict.find(testData[feature]);
+        probability *= getConditional(pairCounts[feature], classCount, val, cls);
       }
     }
 
-    classProbabilities[className] = probability;
+    classProbabilities[cls] = probability;
     totalProb += probability;
   }
 
   string prediction;
   double maxProb = -1;
 
-  for (auto &cp : classProbabilities)
+  for (uint32_t cls = 0; cls < classes.size(); cls++)
   {
-    double normalizedProb = cp.second / totalProb;
-    fout << cp.first << "," << normalizedProb << "\n";
+    double normalizedProb = classProbabilities[cls] / totalProb;
+    fout << classes.value(cls) << "," << normalizedProb << "\n";
 
     if (normalizedProb > maxProb)
     {
       maxProb = normalizedProb;
-      prediction = cp.first;
+      prediction = classes.value(cls);
     }
   }
 
@@ -3,8 +3,15 @@
 #include <sstream>
 #include <vector>
 #include <cmath>
+#include "../common/csv_stream.h"
+#include "../common/numeric_parse.h"
 using namespace std;
 
+bool readPoint(const CSVStream &stream, size_t r, int xCol, int yCol, double &x, double &y)
+{
+  return parseNumber(stream.cell(r, xCol), x) == ParseStatus::Ok && parseNumber(stream.cell(r, yCol), y) == ParseStatus::Ok;
+}
+
 int main(int argc, char *argv[])
 {
   if (argc < 2)
@@ -13,20 +20,13 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  ifstream file(argv[1]);
-  string line;
-  vector<double> X, Y;
-  vector<string> headers;
-
-  if (getline(file, line))
+  CSVStream stream;
+  if (!stream.open(argv[1]))
   {
-    stringstream ss(line);
-    string header;
-    while (getline(ss, header, ','))
-    {
-      headers.push_back(header);
-    }
+    cerr << "Error: Cannot open file " << argv[1] << endl;
+    return 1;
   }
+  vector<string> headers = stream.headerNames();
 
   if (headers.size() < 2)
   {
@@ -42,41 +42,30 @@ int main(int argc, char *argv[])
   cout << "  Y (Dependent Variable): " << headers[yCol] << " (column " << yCol << ")" << endl;
   cout << endl;
 
-  while (getline(file, line))
+  long long n = 0, skipped = 0;
+  double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
+  while (stream.next())
   {
-    stringstream ss(line);
-    vector<string> row;
-    string cell;
-    while (getline(ss, cell, ','))
-    {
-      row.push_back(cell);
-    }
-    
-    if (row.size() > max(xCol, yCol))
+    for (size_t r = 0; r < stream.rows(); r++)
     {
-      try
+      if (stream.width(r) <= (size_t)max(xCol, yCol))
+        continue;
+      double x, y;
+      if (!readPoint(stream, r, xCol, yCol, x, y))
       {
-        X.push_back(stod(row[xCol]));
-        Y.push_back(stod(row[yCol]));
-      }
-      catch (...)
-      {
-        cerr << "Warning: Invalid numeric data in row, skipping..." << endl;
+        skipped++;
+        continue;
       }
+      n++;
+      sumX += x;
+      sumY += y;
+      sumXY += x * y;
+      sumX2 += x * x;
     }
   }
-  file.close();
-
-  int n = X.size();
-  double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
-
-  for (int i = 0; i < n; i++)
-  {
-    sumX += X[i];
-    sumY += Y[i];
-    sumXY += X[i] * Y[i];
-    sumX2 += X[i] * X[i];
-  }
+  stream.printLoadStats();
+  if (skipped)
+    cerr << "Warning: Skipped " << skipped << " rows with invalid numeric data" << endl;
 
   double slope = (n * sumXY - sumX * sumY) / (n * sumX2 - sumX * sumX);
   double intercept = (sumY - slope * sumX) / n;
@@ -93,9 +82,15 @@ int main(int argc, char *argv[])
 
   ofstream fout("output.csv");
   fout << headers[xCol] << "," << headers[yCol] << ",Predicted_" << headers[yCol] << "\n";
-  for (int i = 0; i < n; i++)
+  stream.open(argv[1]);
+  while (stream.next())
   {
-    fout << X[i] << "," << Y[i] << "," << (slope * X[i] + intercept) << "\n";
+    for (size_t r = 0; r < stream.rows(); r++)
+    {
+      double x, y;
+      if (stream.width(r) > (size_t)max(xCol, yCol) && readPoint(stream, r, xCol, yCol, x, y))
+        fout << x << "," << y << "," << (slope * x + intercept) << "\n";
+    }
   }
   fout << x_val << ",," << y_pred << "\n";
   fout.close();
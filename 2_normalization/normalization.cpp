@@ -6,6 +6,9 @@
 #include <string>
 #include <algorithm>
 #include <set>
+#include <map>
+#include "../common/csv_loader.h"
+#include "../common/csv_writer.h"
 using namespace std;
 
 double calculateMean(const vector<double> &values)
@@ -80,57 +83,43 @@ vector<double> decimalScalingNormalize(const vector<double> &data)
   return normalized;
 }
 
-vector<string> splitLine(const string &line, char delimiter = ',')
-{
-  vector<string> tokens;
-  string token;
-  stringstream ss(line);
-  while (getline(ss, token, delimiter))
-    tokens.push_back(token);
-  return tokens;
-}
-
 vector<vector<string>> loadCSV(const string &filename, vector<string> &headers)
 {
-  ifstream file(filename);
+  CSVTable table;
   vector<vector<string>> data;
-  if (!file.is_open())
+  if (!table.load(filename))
     throw runtime_error("Could not open file " + filename);
 
-  string line;
-  if (getline(file, line))
-    headers = splitLine(line);
-
-  while (getline(file, line))
-  {
-    vector<string> row = splitLine(line);
-    if (!row.empty())
-      data.push_back(row);
-  }
-  file.close();
+  headers = table.headerNames();
+  for (size_t r = 0; r < table.rows(); r++)
+    data.push_back(table.rowText(r));
+  table.printLoadStats();
   return data;
 }
 
-void saveCSV(const string &filename, const vector<vector<string>> &data, const vector<string> &headers)
+void saveCSV(const string &filename, const vector<vector<string>> &data, const vector<string> &headers,
+             const map<int, vector<double>> &normalized)
 {
-  ofstream file(filename);
-  for (size_t i = 0; i < headers.size(); i++)
-  {
-    file << headers[i];
-    if (i < headers.size() - 1)
-      file << ",";
-  }
-  file << "\n";
+  vector<const vector<double> *> normalizedColumns(headers.size(), nullptr);
+  for (const auto &column : normalized)
+    normalizedColumns[column.first] = &column.second;
 
-  for (const auto &row : data)
+  CSVWriter file;
+  file.open(filename);
+  for (const auto &header : headers)
+    file.cell(header);
+  file.endRow();
+
+  for (size_t r = 0; r < data.size(); r++)
   {
-    for (size_t i = 0; i < row.size(); i++)
+    for (size_t i = 0; i < data[r].size(); i++)
     {
-      file << row[i];
-      if (i < row.size() - 1)
-        file << ",";
+      if (i < normalizedColumns.size() && normalizedColumns[i])
+        file.fixedCell((*normalizedColumns[i])[r], 6);
+      else
+        file.cell(data[r][i]);
     }
-    file << "\n";
+    file.endRow();
   }
   file.close();
   cout << "Saved: " << filename << endl;
@@ -216,7 +205,7 @@ int main(int argc, char *argv[])
     cin >> new_max;
   }
 
-  vector<vector<string>> normalized_dataset = dataset;
+  map<int, vector<double>> normalized_columns;
 
   for (int col_idx : columns_to_normalize)
   {
@@ -250,13 +239,10 @@ int main(int argc, char *argv[])
       return 1;
     }
 
-    for (size_t i = 0; i < normalized_dataset.size(); i++)
-    {
-      normalized_dataset[i][col_idx] = to_string(normalized_column[i]);
-    }
+    normalized_columns[col_idx] = normalized_column;
   }
 
-  saveCSV("output.csv", normalized_dataset, headers);
+  saveCSV("output.csv", dataset, headers, normalized_columns);
   cout << "Normalization Completed Successfully!\n";
 
   return 0;
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <cctype>
 #include <sstream>
+#include "../common/csv_loader.h"
+#include "../common/cli_flags.h"
 
 using namespace std;
 
@@ -33,80 +35,35 @@ string toLower(const string &str)
 }
 
 // Load CSV data with error handling and proper CSV parsing
-vector<CSVRecord> loadCSV(const string &filename, vector<string> &headers)
+vector<CSVRecord> loadCSV(const string &filename, vector<string> &headers, int threads)
 {
   vector<CSVRecord> records;
-  ifstream file(filename);
+  CSVTable table;
 
-  if (!file.is_open())
+  if (!table.load(filename, threads))
   {
     cerr << "Error: Could not open file " << filename << endl;
     return records;
   }
 
-  string line;
-  // Read headers
-  if (getline(file, line))
-  {
-    stringstream ss(line);
-    string header;
-    while (getline(ss, header, ','))
-    {
-      headers.push_back(trim(header));
-    }
-  }
+  headers = table.headerNames(true);
 
-  // Read data records
-  while (getline(file, line))
+  // Quoted fields with embedded commas are handled by the shared tokenizer
+  for (size_t r = 0; r < table.rows(); r++)
   {
-    if (line.empty())
-      continue;
-
-    CSVRecord record;
-    stringstream ss(line);
-    string field;
-    bool inQuotes = false;
-    string currentField;
-
-    // Improved CSV parsing to handle quoted fields with commas
-    for (size_t i = 0; i < line.length(); i++)
-    {
-      char c = line[i];
-
-      if (c == '"')
-      {
-        inQuotes = !inQuotes;
-      }
-      else if (c == ',' && !inQuotes)
-      {
-        record.fields.push_back(trim(currentField));
-        currentField.clear();
-      }
-      else
-      {
-        currentField += c;
-      }
-    }
-
-    // Don't forget the last field
-    if (!currentField.empty())
-    {
-      record.fields.push_back(trim(currentField));
-    }
-
     // Ensure all records have same number of fields as headers
-    if (record.fields.size() == headers.size())
+    if (table.width(r) == headers.size())
     {
-      records.push_back(record);
+      records.push_back({table.rowText(r, true)});
     }
-    else if (record.fields.size() > 0) // Only warn if we actually have fields
+    else
     {
-      cerr << "Warning: Skipped record with " << record.fields.size()
-           << " fields (expected " << headers.size() << "): " << line << endl;
+      cerr << "Warning: Skipped record " << r + 1 << " with " << table.width(r)
+           << " fields (expected " << headers.size() << ")" << endl;
     }
   }
 
-  file.close();
+  table.printLoadStats();
   return records;
 }
 
@@ -320,14 +277,15 @@ void showHelp()
 
 int main(int argc, char *argv[])
 {
-  if (argc != 2)
+  int threads = takeThreadsFlag(argc, argv);
+  if (argc != 2 || threads < 1)
   {
-    cerr << "Usage: " << argv[0] << " <csv_file>" << endl;
+    cerr << "Usage: " << argv[0] << " <csv_file> [--threads N]" << endl;
     return 1;
   }
 
   vector<string> headers;
-  vector<CSVRecord> records = loadCSV(argv[1], headers);
+  vector<CSVRecord> records = loadCSV(argv[1], headers, threads);
 
   if (records.empty())
   {
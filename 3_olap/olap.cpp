@@ -2,59 +2,73 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <map>
 #include <algorithm>
 #include <sstream>
+#include "../common/categorical.h"
+#include "../common/csv_stream.h"
+#include "../common/csv_writer.h"
+#include "../common/numeric_parse.h"
 using namespace std;
 
-vector<vector<string>> dataset;
+string inputFile;
 vector<string> headers;
 
-void loadCSV(string filename)
+size_t loadCSV(string filename)
 {
-  ifstream file(filename);
-  string line;
-
-  getline(file, line);
-  stringstream ss(line);
-  string header;
-  while (getline(ss, header, ','))
-    headers.push_back(header);
+  inputFile = filename;
+  CSVStream stream;
+  if (!stream.open(filename))
+    return 0;
+
+  headers = stream.headerNames();
+  size_t records = 0;
+  while (stream.next())
+    records += stream.rows();
+  stream.printLoadStats();
+  return records;
+}
 
-  while (getline(file, line))
-  {
-    stringstream ss(line);
-    vector<string> row;
-    string value;
-    while (getline(ss, value, ','))
-      row.push_back(value);
-    dataset.push_back(row);
-  }
-  file.close();
+void writeRow(ofstream &file, const vector<string> &row)
+{
+  CSVFormatter line;
+  for (const auto &cell : row)
+    line.cell(cell);
+  line.endRow();
+  file << line.buffer();
 }
 
 void saveCSV(string filename, vector<vector<string>> result)
 {
   ofstream file(filename);
-  for (size_t i = 0; i < headers.size(); i++)
-  {
-    file << headers[i];
-    if (i < headers.size() - 1)
-      file << ",";
-  }
-  file << "\n";
-  
+  writeRow(file, headers);
   for (auto &row : result)
+    writeRow(file, row);
+  file.close();
+}
+
+size_t saveMatching(string filename, const vector<pair<int, string>> &filters)
+{
+  ofstream file(filename);
+  writeRow(file, headers);
+  size_t matches = 0;
+  CSVStream stream;
+  stream.open(inputFile);
+  while (stream.next())
   {
-    for (size_t i = 0; i < row.size(); i++)
+    for (size_t r = 0; r < stream.rows(); r++)
     {
-      file << row[i];
-      if (i < row.size() - 1)
-        file << ",";
+      bool match = true;
+      for (auto &f : filters)
+        match = match && (size_t)f.first < stream.width(r) && stream.cellText(r, f.first) == f.second;
+      if (match)
+      {
+        writeRow(file, stream.rowText(r));
+        matches++;
+      }
     }
-    file << "\n";
   }
   file.close();
+  return matches;
 }
 
 int findColumn(string name)
@@ -84,18 +98,33 @@ void rollup()
     return;
   }
 
-  map<string, int> counts;
-  for (auto &row : dataset)
-    counts[row[col]]++;
+  Dictionary levels;
+  vector<int> counts;
+  CSVStream stream;
+  stream.open(inputFile);
+  while (stream.next())
+    for (size_t r = 0; r < stream.rows(); r++)
+      if ((size_t)col < stream.width(r))
+      {
+        uint32_t code = internCell(levels, stream, r, col);
+        if (code == counts.size())
+          counts.push_back(0);
+        counts[code]++;
+      }
+
+  vector<uint32_t> remap = levels.sort();
+  vector<int> sortedCounts(counts.size());
+  for (size_t code = 0; code < counts.size(); code++)
+    sortedCounts[remap[code]] = counts[code];
 
   cout << "\nRoll-up by " << dimension << ":\n";
-  for (auto &pair : counts)
-    cout << "  " << pair.first << ": " << pair.second << " records\n";
+  for (uint32_t code = 0; code < levels.size(); code++)
+    cout << "  " << levels.value(code) << ": " << sortedCounts[code] << " records\n";
 
   vector<vector<string>> rollupResult;
-  for (auto &pair : counts)
+  for (uint32_t code = 0; code < levels.size(); code++)
   {
-    vector<string> resultRow = {pair.first, to_string(pair.second)};
+    vector<string> resultRow = {levels.value(code), to_string(sortedCounts[code])};
     rollupResult.push_back(resultRow);
   }
   
@@ -128,15 +157,8 @@ void slice()
     return;
   }
 
-  vector<vector<string>> result;
-  for (auto &row : dataset)
-  {
-    if (row[col] == value)
-      result.push_back(row);
-  }
-
-  saveCSV("slice_output.csv", result);
-  cout << "Found " << result.size() << " records\n";
+  size_t found = saveMatching("slice_output.csv", {{col, value}});
+  cout << "Found " << found << " records\n";
   cout << "Slice saved to slice_output.csv\n";
 }
 
@@ -164,15 +186,8 @@ void dice()
     return;
   }
 
-  vector<vector<string>> result;
-  for (auto &row : dataset)
-  {
-    if (row[col1] == val1 && row[col2] == val2)
-      result.push_back(row);
-  }
-
-  saveCSV("dice_output.csv", result);
-  cout << "Found " << result.size() << " records\n";
+  size_t found = saveMatching("dice_output.csv", {{col1, val1}, {col2, val2}});
+  cout << "Found " << found << " records\n";
   cout << "Dice saved to dice_output.csv\n";
 }
 
@@ -199,17 +214,40 @@ void cube()
     return;
   }
   
-  map<string, map<string, int>> cubeData;
-  map<string, int> dim1Totals;
-  map<string, int> dim2Totals;
+  Dictionary levels1, levels2;
+  vector<vector<int>> counts;
   int grandTotal = 0;
   
-  for (auto &row : dataset)
+  CSVStream stream;
+  stream.open(inputFile);
+  while (stream.next())
   {
-    cubeData[row[col1]][row[col2]]++;
-    dim1Totals[row[col1]]++;
-    dim2Totals[row[col2]]++;
-    grandTotal++;
+    for (size_t r = 0; r < stream.rows(); r++)
+    {
+      if ((size_t)max(col1, col2) >= stream.width(r))
+        continue;
+      uint32_t v1 = internCell(levels1, stream, r, col1), v2 = internCell(levels2, stream, r, col2);
+      if (v1 == counts.size())
+        counts.emplace_back();
+      if (v2 >= counts[v1].size())
+        counts[v1].resize(v2 + 1, 0);
+      counts[v1][v2]++;
+      grandTotal++;
+    }
+  }
+
+  vector<uint32_t> remap1 = levels1.sort(), remap2 = levels2.sort();
+  size_t n1 = levels1.size(), n2 = levels2.size();
+  vector<int> cubeData(n1 * n2, 0), dim1Totals(n1, 0), dim2Totals(n2, 0);
+  for (size_t c1 = 0; c1 < counts.size(); c1++)
+  {
+    for (size_t c2 = 0; c2 < counts[c1].size(); c2++)
+    {
+      uint32_t v1 = remap1[c1], v2 = remap2[c2];
+      cubeData[v1 * n2 + v2] += counts[c1][c2];
+      dim1Totals[v1] += counts[c1][c2];
+      dim2Totals[v2] += counts[c1][c2];
+    }
   }
   
   ofstream cubeFile("cube_output.csv");
@@ -217,21 +255,22 @@ void cube()
   
   cubeFile << "ALL,ALL," << grandTotal << ",Grand Total\n";
   
-  for (auto &d1 : dim1Totals)
+  for (size_t v1 = 0; v1 < n1; v1++)
   {
-    cubeFile << d1.first << ",ALL," << d1.second << "," << dim1 << " Subtotal\n";
+    cubeFile << levels1.value(v1) << ",ALL," << dim1Totals[v1] << "," << dim1 << " Subtotal\n";
   }
   
-  for (auto &d2 : dim2Totals)
+  for (size_t v2 = 0; v2 < n2; v2++)
   {
-    cubeFile << "ALL," << d2.first << "," << d2.second << "," << dim2 << " Subtotal\n";
+    cubeFile << "ALL," << levels2.value(v2) << "," << dim2Totals[v2] << "," << dim2 << " Subtotal\n";
   }
   
-  for (auto &d1 : cubeData)
+  for (size_t v1 = 0; v1 < n1; v1++)
   {
-    for (auto &d2 : d1.second)
+    for (size_t v2 = 0; v2 < n2; v2++)
     {
-      cubeFile << d1.first << "," << d2.first << "," << d2.second << ",Detail\n";
+      if (cubeData[v1 * n2 + v2])
+        cubeFile << levels1.value(v1) << "," << levels2.value(v2) << "," << cubeData[v1 * n2 + v2] << ",Detail\n";
     }
   }
   
@@ -239,8 +278,8 @@ void cube()
   
   cout << "\nCUBE Results:\n";
   cout << "Grand Total: " << grandTotal << " records\n";
-  cout << dim1 << " has " << dim1Totals.size() << " categories\n";
-  cout << dim2 << " has " << dim2Totals.size() << " categories\n";
+  cout << dim1 << " has " << n1 << " categories\n";
+  cout << dim2 << " has " << n2 << " categories\n";
   cout << "CUBE operation completed\n";
   cout << "Results saved to cube_output.csv\n";
 }
@@ -264,17 +303,9 @@ void drilldown()
     return;
   }
 
-  vector<vector<string>> drilldownResult;
-  for (auto &row : dataset)
-  {
-    if (row[col] == value)
-      drilldownResult.push_back(row);
-  }
-
+  size_t found = saveMatching("drilldown_output.csv", {{col, value}});
   cout << "Drill-down into " << dimension << " = " << value << ":\n";
-  cout << "Found " << drilldownResult.size() << " detailed records\n";
-
-  saveCSV("drilldown_output.csv", drilldownResult);
+  cout << "Found " << found << " detailed records\n";
   cout << "Drilldown saved to drilldown_output.csv\n";
 }
 
@@ -302,44 +333,76 @@ void pivot()
     return;
   }
 
-  map<string, map<string, double>> pivotTable;
-  map<string, double> rowTotals;
-  map<string, double> colTotals;
+  Dictionary rowLevels, colLevels;
+  vector<vector<double>> cells;
+  vector<double> rowSums, colSums;
   double grandTotal = 0;
 
-  for (auto &row : dataset)
+  ColumnParseStats measureStats;
+  CSVStream stream;
+  stream.open(inputFile);
+  while (stream.next())
+  {
+    for (size_t r = 0; r < stream.rows(); r++)
+    {
+      if ((size_t)max(rowCol, max(colCol, measureCol)) >= stream.width(r))
+        continue;
+      uint32_t rowVal = internCell(rowLevels, stream, r, rowCol);
+      uint32_t colVal = internCell(colLevels, stream, r, colCol);
+      double measureVal = 0;
+      if (measureStats.record(parseNumber(stream.cell(r, measureCol), measureVal)) != ParseStatus::Ok)
+        measureVal = 0;
+
+      if (rowVal == cells.size())
+      {
+        cells.emplace_back();
+        rowSums.push_back(0);
+      }
+      if (colVal == colSums.size())
+        colSums.push_back(0);
+      if (colVal >= cells[rowVal].size())
+        cells[rowVal].resize(colVal + 1, 0);
+      cells[rowVal][colVal] += measureVal;
+      rowSums[rowVal] += measureVal;
+      colSums[colVal] += measureVal;
+      grandTotal += measureVal;
+    }
+  }
+  printParseStats({measure}, {measureStats});
+
+  vector<uint32_t> rowRemap = rowLevels.sort(), colRemap = colLevels.sort();
+  size_t rowsOut = rowLevels.size(), colsOut = colLevels.size();
+  vector<double> pivotTable(rowsOut * colsOut, 0), rowTotals(rowsOut), colTotals(colsOut);
+  for (size_t r = 0; r < cells.size(); r++)
   {
-    string rowVal = row[rowCol];
-    string colVal = row[colCol];
-    double measureVal = stod(row[measureCol]);
-
-    pivotTable[rowVal][colVal] += measureVal;
-    rowTotals[rowVal] += measureVal;
-    colTotals[colVal] += measureVal;
-    grandTotal += measureVal;
+    rowTotals[rowRemap[r]] = rowSums[r];
+    for (size_t c = 0; c < cells[r].size(); c++)
+      pivotTable[rowRemap[r] * colsOut + colRemap[c]] = cells[r][c];
   }
+  for (size_t c = 0; c < colSums.size(); c++)
+    colTotals[colRemap[c]] = colSums[c];
 
   vector<vector<string>> pivotResult;
   vector<string> headerRow = {rowDim + "\\" + colDim};
-  for (auto &col : colTotals)
-    headerRow.push_back(col.first);
+  for (size_t c = 0; c < colsOut; c++)
+    headerRow.push_back(colLevels.value(c));
   headerRow.push_back("Total");
   pivotResult.push_back(headerRow);
 
-  for (auto &row : pivotTable)
+  for (size_t r = 0; r < rowsOut; r++)
   {
-    vector<string> pivotRow = {row.first};
-    for (auto &col : colTotals)
+    vector<string> pivotRow = {rowLevels.value(r)};
+    for (size_t c = 0; c < colsOut; c++)
     {
-      pivotRow.push_back(to_string(row.second[col.first]));
+      pivotRow.push_back(to_string(pivotTable[r * colsOut + c]));
     }
-    pivotRow.push_back(to_string(rowTotals[row.first]));
+    pivotRow.push_back(to_string(rowTotals[r]));
     pivotResult.push_back(pivotRow);
   }
 
   vector<string> totalRow = {"Total"};
-  for (auto &col : colTotals)
-    totalRow.push_back(to_string(col.second));
+  for (size_t c = 0; c < colsOut; c++)
+    totalRow.push_back(to_string(colTotals[c]));
   totalRow.push_back(to_string(grandTotal));
   pivotResult.push_back(totalRow);
 
@@ -355,8 +418,8 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  loadCSV(argv[1]);
-  cout << "Loaded " << dataset.size() << " records with " << headers.size() << " columns\n\n";
+  size_t records = loadCSV(argv[1]);
+  cout << "Loaded " << records << " records with " << headers.size() << " columns\n\n";
 
   while (true)
   {
@@ -3,54 +3,23 @@
 #include <vector>
 #include <string>
 #include <sstream>
-#include <iomanip>
 #include <map>
 #include <algorithm>
+#include "../common/csv_stream.h"
+#include "../common/numeric_parse.h"
+#include "../common/csv_writer.h"
 using namespace std;
 
-string trim(const string &str)
-{
-  size_t start = str.find_first_not_of(" \t\n\r");
-  size_t end = str.find_last_not_of(" \t\n\r");
-  if (start == string::npos || end == string::npos)
-    return "";
-  return str.substr(start, end - start + 1);
-}
-
-bool isNumeric(const string &str)
-{
-  if (str.empty())
-    return false;
-  if (str == "N/A" || str == "NA" || str == "-" || str == "null")
-    return false;
-
-  bool hasDecimal = false, hasDigit = false;
-  for (char c : str)
-  {
-    if (c == '.' && !hasDecimal)
-      hasDecimal = true;
-    else if (!isdigit(c) && c != ' ' && c != ',')
-      return false;
-    else if (isdigit(c))
-      hasDigit = true;
-  }
-  return hasDigit;
-}
-
-double toDouble(const string &str)
+ParseStatus parseMeasure(const string &str, double &value)
 {
   string cleanStr;
   for (char c : str)
     if (c != ',')
       cleanStr += c;
-  try
-  {
-    return stod(cleanStr);
-  }
-  catch (...)
-  {
-    return 0.0;
-  }
+  ParseStatus status = parseNumber(cleanStr, value);
+  if (status != ParseStatus::Ok)
+    value = 0.0;
+  return status;
 }
 
 int main(int argc, char *argv[])
@@ -62,37 +31,14 @@ int main(int argc, char *argv[])
   }
 
   string inputFilename = argv[1];
-  ifstream inputFile(inputFilename);
-  if (!inputFile.is_open())
+  CSVStream stream;
+  if (!stream.open(inputFilename))
   {
     cerr << "Error: Could not open input file " << inputFilename << endl;
     return 1;
   }
 
-  vector<vector<string>> data;
-  vector<string> headers;
-  string line;
-
-  if (getline(inputFile, line))
-  {
-    stringstream ss(line);
-    string header;
-    while (getline(ss, header, ','))
-      headers.push_back(trim(header));
-  }
-
-  while (getline(inputFile, line))
-  {
-    stringstream ss(line);
-    string cell;
-    vector<string> row;
-
-    while (getline(ss, cell, ','))
-      row.push_back(trim(cell));
-    if (row.size() >= 3)
-      data.push_back(row);
-  }
-  inputFile.close();
+  vector<string> headers = stream.headerNames(true);
 
   if (headers.size() < 3)
   {
@@ -113,45 +59,68 @@ int main(int argc, char *argv[])
   map<string, double> rowTotals;
   map<string, double> colTotals;
   double grandTotal = 0.0;
+  ColumnParseStats measureStats;
 
   vector<string> rowNames, colNames;
-  for (const auto &row : data)
+  while (stream.next())
   {
-    string rowName = row[rowDim];
-    string colName = row[colDim];
-
-    if (find(rowNames.begin(), rowNames.end(), rowName) == rowNames.end())
-      rowNames.push_back(rowName);
-    if (find(colNames.begin(), colNames.end(), colName) == colNames.end())
-      colNames.push_back(colName);
-
-    double value = isNumeric(row[measureCol]) ? toDouble(row[measureCol]) : 0.0;
-    pivotTable[rowName][colName] = value;
-    rowTotals[rowName] += value;
-    colTotals[colName] += value;
-    grandTotal += value;
+    for (size_t r = 0; r < stream.rows(); r++)
+    {
+      if (stream.width(r) < 3)
+        continue;
+      string rowName(trimView(stream.cellText(r, rowDim)));
+      string colName(trimView(stream.cellText(r, colDim)));
+
+      if (!rowTotals.count(rowName))
+        rowNames.push_back(rowName);
+      if (!colTotals.count(colName))
+        colNames.push_back(colName);
+
+      double value;
+      measureStats.record(parseMeasure(stream.cellText(r, measureCol), value));
+      pivotTable[rowName][colName] = value;
+      rowTotals[rowName] += value;
+      colTotals[colName] += value;
+      grandTotal += value;
+    }
   }
+  stream.printLoadStats();
+
+  printParseStats({headers[measureCol]}, {measureStats});
 
-  ofstream outputFile("output.csv");
-  if (!outputFile.is_open())
+  CSVWriter outputFile;
+  if (!outputFile.open("output.csv"))
   {
     cerr << "Error: Could not create output file output.csv" << endl;
     return 1;
   }
 
-  outputFile << headers[rowDim] << "\\" << headers[colDim] << ",";
+  outputFile.cell(headers[rowDim] + "\\" + headers[colDim]);
   for (const auto &col : colNames)
-    outputFile << col << ",,,";
-  outputFile << "Total,," << endl;
+  {
+    outputFile.cell(col);
+    outputFile.cell("");
+    outputFile.cell("");
+  }
+  outputFile.cell("Total");
+  outputFile.cell("");
+  outputFile.cell("");
+  outputFile.endRow();
 
-  outputFile << ",";
   for (size_t i = 0; i < colNames.size(); i++)
-    outputFile << "Count,t-weight,d-weight,";
-  outputFile << "Count,t-weight,d-weight" << endl;
+    outputFile.text(",Count,t-weight,d-weight");
+  outputFile.text(",Count,t-weight,d-weight");
+  outputFile.endRow();
+
+  auto percentCell = [&](double weight)
+  {
+    outputFile.fixedCell(weight, 2);
+    outputFile.text("%");
+  };
 
   for (const auto &row : rowNames)
   {
-    outputFile << row << ",";
+    outputFile.cell(row);
     double rowTotal = rowTotals[row];
 
     for (const auto &col : colNames)
@@ -160,22 +129,31 @@ int main(int argc, char *argv[])
       double tWeight = (rowTotal > 0) ? (value / rowTotal) * 100 : 0;
       double dWeight = (colTotals[col] > 0) ? (value / colTotals[col]) * 100 : 0;
 
-      outputFile << value << "," << fixed << setprecision(2) << tWeight << "%," << dWeight << "%,";
+      outputFile.fixedCell(value, 2);
+      percentCell(tWeight);
+      percentCell(dWeight);
     }
 
     double totalDWeight = (grandTotal > 0) ? (rowTotal / grandTotal) * 100 : 0;
-    outputFile << rowTotal << "," << fixed << setprecision(2) << "100.00%," << totalDWeight << "%" << endl;
+    outputFile.fixedCell(rowTotal, 2);
+    outputFile.cell("100.00%");
+    percentCell(totalDWeight);
+    outputFile.endRow();
   }
 
-  outputFile << "Total,";
+  outputFile.cell("Total");
   for (const auto &col : colNames)
   {
     double colTotal = colTotals[col];
     double tWeight = (grandTotal > 0) ? (colTotal / grandTotal) * 100 : 0;
-    outputFile << colTotal << "," << fixed << setprecision(2) << tWeight << "%,100.00%,";
+    outputFile.fixedCell(colTotal, 2);
+    percentCell(tWeight);
+    outputFile.cell("100.00%");
   }
 
-  outputFile << grandTotal << ",100.00%,100.00%" << endl;
+  outputFile.fixedCell(grandTotal, 2);
+  outputFile.text(",100.00%,100.00%");
+  outputFile.endRow();
   outputFile.close();
 
   cout << "Successfully generated pivot table: output.csv" << endl;
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <map>
 #include <cmath>
+#include "../common/column_cache.h"
+#include "../common/cli_flags.h"
 using namespace std;
 
 double median_of_range(const vector<double> &v, size_t lo, size_t hi)
@@ -46,61 +48,44 @@ vector<double> detect_outliers(const vector<double> &data, double q1, double q3)
   return o;
 }
 
-map<string, vector<double>> read_csv(const string &path)
+map<string, vector<size_t>> read_columns(ColumnCache &table, const string &path)
 {
-  ifstream f(path);
-  map<string, vector<double>> cols;
-  string line;
-  if (!getline(f, line))
+  map<string, vector<size_t>> cols;
+  if (!table.open(path) || table.columns() == 0)
     return cols;
 
-  vector<string> headers;
-  stringstream hs(line);
-  string h;
-  while (getline(hs, h, ','))
-    headers.push_back(h);
-  for (auto &x : headers)
-    cols[x];
-
-  while (getline(f, line))
-  {
-    stringstream ss(line);
-    string val;
-    int i = 0;
-    while (getline(ss, val, ','))
-    {
-      try
-      {
-        cols[headers[i]].push_back(stod(val));
-      }
-      catch (...)
-      {
-      }
-      i++;
-    }
-  }
+  vector<string> headers = table.headerNames();
+  for (size_t i = 0; i < headers.size(); i++)
+    cols[headers[i]].push_back(i);
+  table.printLoadStats();
+  printParseStats(headers, table.stats());
   return cols;
 }
 
 int main(int argc, char *argv[])
 {
+  string na;
+  if (takeFlag(argc, argv, "--na", na))
+    naTokens().set(na);
   if (argc < 2)
   {
-    cout << "Usage: " << argv[0] << " <input.csv>\n";
+    cout << "Usage: " << argv[0] << " <input.csv> [--na TOKEN,TOKEN...]\n";
     return 1;
   }
 
-  auto cols = read_csv(argv[1]);
+  ColumnCache table;
+  auto cols = read_columns(table, argv[1]);
   if (cols.empty())
   {
     cout << "No numeric columns found.\n";
     return 1;
   }
 
+  vector<ColumnParseStats> stats = table.stats();
   vector<string> keys;
   cout << "Available numeric columns:\n";
   for (auto &kv : cols)
-    if (!kv.second.empty())
+    if (any_of(kv.second.begin(), kv.second.end(), [&](size_t c) { return stats[c].valid > 0; }))
     {
       keys.push_back(kv.first);
       cout << keys.size() << ". " << kv.first << "\n";
@@ -115,7 +100,12 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  auto data = cols[keys[ch - 1]];
+  vector<double> data;
+  for (size_t c : cols[keys[ch - 1]])
+  {
+    vector<double> values = table.numbers(c);
+    data.insert(data.end(), values.begin(), values.end());
+  }
   double minv, q1, med, q3, maxv;
   five_number_summary(data, minv, q1, med, q3, maxv);
   auto outliers = detect_outliers(data, q1, q3);
@@ -5,174 +5,1525 @@
 #include <string>
 #include <algorithm>
 #include <unordered_map>
-#include <unordered_set>
 #include <cmath>
 #include <cctype>
+#include <thread>
+#include <random>
+#include <queue>
+#include <iomanip>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include "../common/csv_stream.h"
+#include "../common/cli_flags.h"
+#include "../common/itemsets.h"
+#include "../common/tidset.h"
 
 using namespace std;
 
-string trim(const string &s)
+vector<size_t> columns_by_name(const vector<string> &item_names)
 {
-    size_t start = s.find_first_not_of(" \t\r\n");
-    if (start == string::npos)
-        return "";
-    size_t end = s.find_last_not_of(" \t\r\n");
-    return s.substr(start, end - start + 1);
+    vector<size_t> columns(item_names.size());
+    for (size_t i = 0; i < columns.size(); i++)
+        columns[i] = i;
+    stable_sort(columns.begin(), columns.end(), [&](size_t a, size_t b) { return item_names[a] < item_names[b]; });
+    return columns;
 }
 
-vector<vector<string>> read_transactions(const string &filename)
+int count_items(const string &filename, int threads, unordered_map<string, int> &item_counts)
 {
-    ifstream file(filename);
-    vector<vector<string>> transactions;
-    string line;
+    CSVStream stream;
+    if (!stream.open(filename, 65536, threads))
+    {
+        cerr << "Error: Cannot open file " << filename << endl;
+        return 0;
+    }
+
+    vector<string> item_names = stream.headerNames(true);
+    vector<size_t> columns = columns_by_name(item_names);
+    vector<int> counts(item_names.size(), 0);
+    vector<size_t> first_seen;
+
+    int transaction_count = 0;
+    while (stream.next())
+    {
+        for (size_t r = 0; r < stream.rows(); r++)
+        {
+            bool has_items = false;
+            for (size_t item_index : columns)
+            {
+                if (item_index < stream.width(r) && trimView(stream.cell(r, item_index)) == "1")
+                {
+                    if (counts[item_index]++ == 0)
+                        first_seen.push_back(item_index);
+                    has_items = true;
+                }
+            }
+            if (has_items)
+                transaction_count++;
+        }
+    }
+
+    for (size_t item_index : first_seen)
+        item_counts[item_names[item_index]] += counts[item_index];
+
+    cout << "Processed " << transaction_count << " transactions with " << item_names.size() << " items" << endl;
+    stream.printLoadStats();
+    return transaction_count;
+}
+
+struct Transactions
+{
+    static const size_t restart_interval = 64;
+
+    vector<uint32_t> suffixes;
+    vector<size_t> offsets = {0};
+    vector<uint32_t> shared;
+    vector<int> weights;
+    size_t rows = 0;
+    size_t occurrences = 0;
+
+    size_t size() const { return weights.size(); }
+    int weight(size_t t) const { return weights[t]; }
+
+    void add(const uint32_t *items, size_t n, int weight, const vector<uint32_t> &previous)
+    {
+        size_t common = 0;
+        if (size() % restart_interval != 0)
+        {
+            while (common < n && common < previous.size() && previous[common] == items[common])
+                ++common;
+        }
+        shared.push_back((uint32_t)common);
+        suffixes.insert(suffixes.end(), items + common, items + n);
+        offsets.push_back(suffixes.size());
+        weights.push_back(weight);
+    }
+};
+
+class TransactionCursor
+{
+public:
+    TransactionCursor(const Transactions &store, size_t first = 0)
+        : store(store), index(first - first % Transactions::restart_interval)
+    {
+        while (index < first)
+            next();
+    }
+
+    void next()
+    {
+        items.resize(store.shared[index]);
+        items.insert(items.end(), store.suffixes.begin() + store.offsets[index],
+                     store.suffixes.begin() + store.offsets[index + 1]);
+        ++index;
+    }
+
+    const uint32_t *begin() const { return items.data(); }
+    const uint32_t *end() const { return items.data() + items.size(); }
+    int weight() const { return store.weights[index - 1]; }
+
+private:
+    const Transactions &store;
+    size_t index;
+    vector<uint32_t> items;
+};
+
+void compress_transactions(const vector<uint32_t> &items, const vector<size_t> &offsets, size_t rows,
+                           Transactions &transactions)
+{
+    vector<uint32_t> order(offsets.size() - 1);
+    for (uint32_t t = 0; t < order.size(); ++t)
+        order[t] = t;
+    auto less_items = [&](uint32_t a, uint32_t b) {
+        return lexicographical_compare(items.begin() + offsets[a], items.begin() + offsets[a + 1],
+                                       items.begin() + offsets[b], items.begin() + offsets[b + 1]);
+    };
+    sort(order.begin(), order.end(), less_items);
+
+    transactions = Transactions();
+    vector<uint32_t> previous;
+    for (size_t i = 0; i < order.size();)
+    {
+        size_t j = i + 1;
+        while (j < order.size() && !less_items(order[i], order[j]))
+            ++j;
+        const uint32_t *first = items.data() + offsets[order[i]];
+        size_t n = offsets[order[i] + 1] - offsets[order[i]];
+        transactions.add(first, n, (int)(j - i), previous);
+        previous.assign(first, first + n);
+        i = j;
+    }
+    transactions.rows = rows;
+    transactions.occurrences = items.size();
+}
+
+class TransactionReader
+{
+public:
+    bool open(const string &filename, int threads, const unordered_map<string, uint32_t> &item_ids,
+              double sample_fraction = 1.0)
+    {
+        fraction = sample_fraction;
+        rng.seed(0x5eed);
+        if (!stream.open(filename, 65536, threads))
+            return false;
+        map_items(item_ids);
+        row = batch_rows = 0;
+        return true;
+    }
+
+    vector<string> item_names() const
+    {
+        vector<string> names = stream.headerNames(true);
+        sort(names.begin(), names.end());
+        names.erase(unique(names.begin(), names.end()), names.end());
+        return names;
+    }
+
+    void map_items(const unordered_map<string, uint32_t> &item_ids)
+    {
+        vector<string> names = stream.headerNames(true);
+        columns.clear();
+        for (size_t item_index : columns_by_name(names))
+        {
+            auto it = item_ids.find(names[item_index]);
+            columns.push_back({item_index, it != item_ids.end() ? it->second : ItemsetIndex::npos});
+        }
+    }
+
+    bool read(Transactions &transactions, size_t budget_bytes = SIZE_MAX, size_t max_rows = SIZE_MAX)
+    {
+        vector<uint32_t> items;
+        vector<size_t> offsets = {0};
+        size_t rows = 0;
+        while (rows < max_rows &&
+               items.size() * sizeof(uint32_t) + offsets.size() * (sizeof(size_t) + sizeof(uint32_t)) < budget_bytes)
+        {
+            if (row == batch_rows)
+            {
+                if (!stream.next())
+                    break;
+                row = 0;
+                batch_rows = stream.rows();
+            }
+            if (fraction < 1.0 && uniform_real_distribution<double>(0.0, 1.0)(rng) >= fraction)
+            {
+                ++row;
+                continue;
+            }
+            size_t start = items.size();
+            bool has_items = false;
+            for (const auto &column : columns)
+            {
+                if (column.first < stream.width(row) && trimView(stream.cell(row, column.first)) == "1")
+                {
+                    has_items = true;
+                    if (column.second != ItemsetIndex::npos && (items.size() == start || items.back() != column.second))
+                        items.push_back(column.second);
+                }
+            }
+            if (items.size() > start)
+                offsets.push_back(items.size());
+            rows += has_items;
+            ++row;
+        }
+        if (rows == 0)
+            return false;
+        compress_transactions(items, offsets, rows, transactions);
+        return true;
+    }
+
+private:
+    CSVStream stream;
+    vector<pair<size_t, uint32_t>> columns;
+    size_t row = 0;
+    size_t batch_rows = 0;
+    double fraction = 1.0;
+    mt19937_64 rng;
+};
+
+Transactions read_transactions(const string &filename, int threads, const unordered_map<string, uint32_t> &item_ids)
+{
+    TransactionReader reader;
+    Transactions transactions;
+    if (!reader.open(filename, threads, item_ids) || !reader.read(transactions))
+        return transactions;
+
+    cout << "Transactions: " << transactions.rows << " rows, " << transactions.size() << " unique; "
+         << transactions.occurrences << " items stored as " << transactions.suffixes.size()
+         << " trie-compressed (ratio " << (double)transactions.occurrences / max<size_t>(transactions.suffixes.size(), 1)
+         << ")" << endl;
+    return transactions;
+}
+
+void join_prefix_groups(const ItemsetIndex &frequent_sets, size_t begin, size_t end, vector<uint32_t> &out,
+                        vector<pair<uint32_t, uint32_t>> &parents)
+{
+    size_t k = frequent_sets.itemsetSize() + 1;
+    size_t n = frequent_sets.size();
+    vector<uint32_t> candidate(k), subset(k - 1);
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const uint32_t *first = frequent_sets[i];
+        for (size_t j = i + 1; j < n; ++j)
+        {
+            const uint32_t *second = frequent_sets[j];
+            if (!equal(first, first + k - 2, second))
+                break;
+
+            copy(first, first + k - 1, candidate.begin());
+            candidate[k - 1] = second[k - 2];
+
+            bool is_valid = true;
+            for (size_t idx = 0; idx + 2 < k && is_valid; ++idx)
+            {
+                copy(candidate.begin(), candidate.begin() + idx, subset.begin());
+                copy(candidate.begin() + idx + 1, candidate.end(), subset.begin() + idx);
+                is_valid = frequent_sets.find(subset.data()) != ItemsetIndex::npos;
+            }
+
+            if (is_valid)
+            {
+                out.insert(out.end(), candidate.begin(), candidate.end());
+                parents.push_back({(uint32_t)i, (uint32_t)j});
+            }
+        }
+    }
+}
+
+ItemsetIndex generate_candidates(const ItemsetIndex &frequent_sets, int threads = 1,
+                                 vector<pair<uint32_t, uint32_t>> *parents = nullptr)
+{
+    size_t k = frequent_sets.itemsetSize() + 1;
+    size_t n = frequent_sets.size();
+    vector<size_t> groups;
+    vector<double> work = {0.0};
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i == 0 || !equal(frequent_sets[i], frequent_sets[i] + k - 2, frequent_sets[i - 1]))
+            groups.push_back(i);
+    }
+    groups.push_back(n);
+    for (size_t g = 0; g + 1 < groups.size(); ++g)
+    {
+        double size = (double)(groups[g + 1] - groups[g]);
+        work.push_back(work.back() + size * size);
+    }
+
+    if (threads > (int)groups.size() - 1)
+        threads = max(1, (int)groups.size() - 1);
+    vector<size_t> cuts = {0};
+    for (int t = 1; t < threads; ++t)
+        cuts.push_back(lower_bound(work.begin(), work.end(), work.back() * t / threads) - work.begin());
+    cuts.push_back(groups.size() - 1);
+
+    vector<vector<uint32_t>> local(threads);
+    vector<vector<pair<uint32_t, uint32_t>>> local_parents(threads);
+    auto join = [&](int t) {
+        join_prefix_groups(frequent_sets, groups[cuts[t]], groups[max(cuts[t], cuts[t + 1])], local[t],
+                           local_parents[t]);
+    };
+    vector<thread> workers;
+    for (int t = 1; t < threads; ++t)
+        workers.emplace_back(join, t);
+    join(0);
+    for (auto &w : workers)
+        w.join();
+
+    size_t total = 0;
+    for (const auto &out : local)
+        total += out.size() / k;
+    ItemsetIndex candidates(k);
+    candidates.reset(k, total);
+    for (int t = 0; t < threads; ++t)
+    {
+        for (size_t c = 0; c < local[t].size(); c += k)
+            candidates.insert(local[t].data() + c);
+        if (parents)
+            parents->insert(parents->end(), local_parents[t].begin(), local_parents[t].end());
+    }
+    return candidates;
+}
+
+class CandidateTrie
+{
+public:
+    explicit CandidateTrie(const ItemsetIndex &candidates) : k(candidates.itemsetSize()), items(k), children(k)
+    {
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            const uint32_t *candidate = candidates[c];
+            const uint32_t *previous = c ? candidates[c - 1] : nullptr;
+            size_t depth = 0;
+            while (previous && depth + 1 < k && previous[depth] == candidate[depth])
+                ++depth;
+            for (; depth < k; ++depth)
+            {
+                items[depth].push_back(candidate[depth]);
+                if (depth + 1 < k)
+                    children[depth].push_back((uint32_t)items[depth + 1].size());
+            }
+        }
+        for (size_t depth = 0; depth + 1 < k; ++depth)
+            children[depth].push_back((uint32_t)items[depth + 1].size());
+    }
+
+    size_t count(const uint32_t *transaction, const uint32_t *transaction_end, int weight, int *counts) const
+    {
+        size_t tested = 0;
+        if ((size_t)(transaction_end - transaction) >= k && !items[0].empty())
+            walk(0, 0, (uint32_t)items[0].size(), transaction, transaction_end, weight, counts, tested);
+        return tested;
+    }
+
+private:
+    size_t k;
+    vector<vector<uint32_t>> items;
+    vector<vector<uint32_t>> children;
+
+    void walk(size_t depth, uint32_t first, uint32_t last, const uint32_t *transaction, const uint32_t *transaction_end,
+              int weight, int *counts, size_t &tested) const
+    {
+        const vector<uint32_t> &level = items[depth];
+        const uint32_t *stop = transaction_end - (k - 1 - depth);
+        if (depth + 1 == k)
+            tested += last - first;
+        while (first < last && transaction < stop)
+        {
+            if (level[first] < *transaction)
+                ++first;
+            else if (*transaction < level[first])
+                ++transaction;
+            else
+            {
+                if (depth + 1 == k)
+                    counts[first] += weight;
+                else
+                    walk(depth + 1, children[depth][first], children[depth][first + 1], transaction + 1,
+                         transaction_end, weight, counts, tested);
+                ++first;
+                ++transaction;
+            }
+        }
+    }
+};
+
+vector<int> count_candidates(const CandidateTrie &trie, const Transactions &transactions, size_t candidates,
+                             int threads, size_t &tested)
+{
+    const size_t line = 64 / sizeof(int);
+    if (threads > (int)transactions.size())
+        threads = max(1, (int)transactions.size());
+    size_t stride = (candidates + line - 1) / line * line + line;
+    vector<int> local(stride * threads, 0);
+    vector<size_t> local_tested(threads * line, 0);
+
+    auto scan = [&](int t) {
+        size_t begin = transactions.size() * t / threads, end = transactions.size() * (t + 1) / threads;
+        int *counts = local.data() + stride * t;
+        size_t visited = 0;
+        TransactionCursor cursor(transactions, begin);
+        for (size_t r = begin; r < end; ++r)
+        {
+            cursor.next();
+            visited += trie.count(cursor.begin(), cursor.end(), cursor.weight(), counts);
+        }
+        local_tested[t * line] = visited;
+    };
+    vector<thread> workers;
+    for (int t = 1; t < threads; ++t)
+        workers.emplace_back(scan, t);
+    scan(0);
+    for (auto &w : workers)
+        w.join();
+
+    vector<int> counts(local.begin(), local.begin() + candidates);
+    for (int t = 1; t < threads; ++t)
+    {
+        const int *partial = local.data() + stride * t;
+        for (size_t c = 0; c < candidates; ++c)
+            counts[c] += partial[c];
+    }
+    for (int t = 0; t < threads; ++t)
+        tested += local_tested[t * line];
+    return counts;
+}
+
+void mine_apriori(const Transactions &transactions, ItemsetIndex frequent_itemsets, int min_support_count, int threads,
+                  vector<pair<vector<uint32_t>, int>> &all_frequent, ostream &log)
+{
+    for (int k = 2; !frequent_itemsets.empty(); ++k)
+    {
+        ItemsetIndex candidates = generate_candidates(frequent_itemsets, threads);
+        if (candidates.empty())
+            break;
+
+        CandidateTrie trie(candidates);
+        size_t tested = 0;
+        vector<int> candidate_counts = count_candidates(trie, transactions, candidates.size(), threads, tested);
+        log << "Candidate " << k << "-itemsets: " << candidates.size() << ", tested per transaction: "
+             << (double)tested / max<size_t>(transactions.size(), 1) << endl;
+
+        ItemsetIndex new_frequent(k);
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            if (candidate_counts[c] >= min_support_count)
+            {
+                new_frequent.insert(candidates[c]);
+                all_frequent.push_back({candidates.itemset(c), candidate_counts[c]});
+            }
+        }
+
+        if (new_frequent.empty())
+            break;
+        log << "Frequent " << k << "-itemsets: " << new_frequent.size() << endl;
+        frequent_itemsets = move(new_frequent);
+    }
+}
+
+void mine_vertical(const Transactions &transactions, ItemsetIndex frequent_itemsets, int min_support_count, int threads,
+                   vector<pair<vector<uint32_t>, int>> &all_frequent, ostream &log)
+{
+    vector<uint32_t> order(transactions.size());
+    for (uint32_t t = 0; t < order.size(); ++t)
+        order[t] = t;
+    stable_sort(order.begin(), order.end(),
+                [&](uint32_t a, uint32_t b) { return transactions.weight(a) < transactions.weight(b); });
+    vector<uint32_t> positions(transactions.size());
+    vector<pair<size_t, int>> weight_groups;
+    for (size_t p = 0; p < order.size(); ++p)
+    {
+        positions[order[p]] = (uint32_t)p;
+        if (weight_groups.empty() || weight_groups.back().second != transactions.weight(order[p]))
+            weight_groups.push_back({p, transactions.weight(order[p])});
+    }
+    weight_groups.push_back({order.size(), 0});
+
+    TidSets tidsets(transactions.size());
+    vector<uint32_t> slots;
+    for (uint32_t i = 0; i < frequent_itemsets.size(); ++i)
+    {
+        uint32_t item = frequent_itemsets[i][0];
+        if (item >= slots.size())
+            slots.resize(item + 1, ItemsetIndex::npos);
+        slots[item] = i;
+        tidsets.add();
+    }
+    TransactionCursor cursor(transactions);
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        cursor.next();
+        for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+        {
+            if (*item < slots.size() && slots[*item] != ItemsetIndex::npos)
+                tidsets.set(slots[*item], positions[t]);
+        }
+    }
+    log << "Vertical tidsets: " << tidsets.words() << " words per itemset, " << popcountLevelName(bestPopcountLevel())
+         << " popcount" << endl;
+
+    for (int k = 2; !frequent_itemsets.empty(); ++k)
+    {
+        vector<pair<uint32_t, uint32_t>> parents;
+        ItemsetIndex candidates = generate_candidates(frequent_itemsets, threads, &parents);
+        if (candidates.empty())
+            break;
+
+        ItemsetIndex new_frequent(k);
+        TidSets new_tidsets(transactions.size());
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            uint64_t *bits = new_tidsets.add();
+            int count = 0;
+            for (size_t g = 0; g + 1 < weight_groups.size(); ++g)
+                count += weight_groups[g].second * (int)andCountRange(tidsets[parents[c].first], tidsets[parents[c].second],
+                                                                      bits, weight_groups[g].first,
+                                                                      weight_groups[g + 1].first);
+            if (count >= min_support_count)
+            {
+                new_frequent.insert(candidates[c]);
+                all_frequent.push_back({candidates.itemset(c), count});
+            }
+            else
+                new_tidsets.pop();
+        }
+
+        if (new_frequent.empty())
+            break;
+        log << "Frequent " << k << "-itemsets: " << new_frequent.size() << endl;
+        frequent_itemsets = move(new_frequent);
+        tidsets = move(new_tidsets);
+    }
+}
+
+void append_by_level(vector<pair<vector<uint32_t>, int>> &found, vector<pair<vector<uint32_t>, int>> &all_frequent,
+                     ostream &log)
+{
+    for (auto &pair : found)
+        sort(pair.first.begin(), pair.first.end());
+    sort(found.begin(), found.end(), [](const pair<vector<uint32_t>, int> &a, const pair<vector<uint32_t>, int> &b) {
+        return a.first.size() != b.first.size() ? a.first.size() < b.first.size() : a.first < b.first;
+    });
+    for (size_t i = 0; i < found.size();)
+    {
+        size_t k = found[i].first.size(), j = i;
+        while (j < found.size() && found[j].first.size() == k)
+            j++;
+        log << "Frequent " << k << "-itemsets: " << j - i << endl;
+        i = j;
+    }
+    move(found.begin(), found.end(), back_inserter(all_frequent));
+}
+
+class FPTree
+{
+public:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    struct Node
+    {
+        uint32_t item;
+        uint32_t parent;
+        uint32_t child;
+        uint32_t sibling;
+        uint32_t next;
+        int count;
+    };
+
+    explicit FPTree(size_t items, size_t expected_nodes = 0) : heads(items, none), supports(items, 0)
+    {
+        nodes.reserve(expected_nodes + 1);
+        nodes.push_back({none, none, none, none, none, 0});
+    }
+
+    void insert(const uint32_t *path, size_t n, int count)
+    {
+        uint32_t current = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint32_t child = nodes[current].child;
+            while (child != none && nodes[child].item != path[i])
+                child = nodes[child].sibling;
+            if (child == none)
+            {
+                child = (uint32_t)nodes.size();
+                nodes.push_back({path[i], current, none, nodes[current].child, heads[path[i]], 0});
+                nodes[current].child = child;
+                heads[path[i]] = child;
+            }
+            nodes[child].count += count;
+            supports[path[i]] += count;
+            current = child;
+        }
+    }
+
+    size_t items() const { return heads.size(); }
+    size_t size() const { return nodes.size() - 1; }
+    bool empty() const { return nodes.size() == 1; }
+    int support(uint32_t item) const { return supports[item]; }
+    uint32_t head(uint32_t item) const { return heads[item]; }
+    const Node &node(uint32_t index) const { return nodes[index]; }
+
+private:
+    vector<Node> nodes;
+    vector<uint32_t> heads;
+    vector<int> supports;
+};
+
+void mine_tree(const FPTree &tree, const vector<uint32_t> &rank_items, int min_support_count, vector<uint32_t> &suffix,
+               vector<pair<vector<uint32_t>, int>> &found)
+{
+    vector<uint32_t> path;
+    for (uint32_t rank = (uint32_t)tree.items(); rank-- > 0;)
+    {
+        int support = tree.support(rank);
+        if (support < min_support_count)
+            continue;
+
+        suffix.push_back(rank);
+        if (suffix.size() > 1)
+        {
+            vector<uint32_t> itemset;
+            for (uint32_t r : suffix)
+                itemset.push_back(rank_items[r]);
+            found.push_back({itemset, support});
+        }
+
+        vector<int> counts(rank, 0);
+        size_t base_nodes = 0;
+        for (uint32_t n = tree.head(rank); n != FPTree::none; n = tree.node(n).next)
+        {
+            for (uint32_t p = tree.node(n).parent; p != 0; p = tree.node(p).parent)
+            {
+                counts[tree.node(p).item] += tree.node(n).count;
+                base_nodes++;
+            }
+        }
+
+        FPTree conditional(rank, base_nodes);
+        for (uint32_t n = tree.head(rank); n != FPTree::none; n = tree.node(n).next)
+        {
+            path.clear();
+            for (uint32_t p = tree.node(n).parent; p != 0; p = tree.node(p).parent)
+            {
+                if (counts[tree.node(p).item] >= min_support_count)
+                    path.push_back(tree.node(p).item);
+            }
+            reverse(path.begin(), path.end());
+            if (!path.empty())
+                conditional.insert(path.data(), path.size(), tree.node(n).count);
+        }
+        if (!conditional.empty())
+            mine_tree(conditional, rank_items, min_support_count, suffix, found);
+        suffix.pop_back();
+    }
+}
+
+void mine_fpgrowth(const Transactions &transactions, size_t item_count, int min_support_count,
+                   vector<pair<vector<uint32_t>, int>> &all_frequent, ostream &log)
+{
+    vector<int> supports(item_count, 0);
+    TransactionCursor counter(transactions);
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        counter.next();
+        for (const uint32_t *item = counter.begin(); item != counter.end(); ++item)
+            supports[*item] += counter.weight();
+    }
+    vector<uint32_t> rank_items(item_count);
+    for (uint32_t id = 0; id < item_count; ++id)
+        rank_items[id] = id;
+    stable_sort(rank_items.begin(), rank_items.end(), [&](uint32_t a, uint32_t b) { return supports[a] > supports[b]; });
+    vector<uint32_t> item_ranks(item_count);
+    for (uint32_t rank = 0; rank < item_count; ++rank)
+        item_ranks[rank_items[rank]] = rank;
+
+    FPTree tree(item_count, transactions.suffixes.size());
+    vector<uint32_t> path;
+    TransactionCursor cursor(transactions);
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        cursor.next();
+        path.clear();
+        for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+            path.push_back(item_ranks[*item]);
+        sort(path.begin(), path.end());
+        tree.insert(path.data(), path.size(), cursor.weight());
+    }
+    log << "FP-tree: " << tree.size() << " nodes for " << transactions.occurrences << " item occurrences ("
+         << tree.size() * sizeof(FPTree::Node) / 1024 << " KB)" << endl;
+
+    vector<pair<vector<uint32_t>, int>> found;
+    vector<uint32_t> suffix;
+    mine_tree(tree, rank_items, min_support_count, suffix, found);
+    append_by_level(found, all_frequent, log);
+}
+
+struct EclatMember
+{
+    uint32_t item;
+    int support;
+    int weight;
+    vector<uint32_t> tids;
+};
+
+struct EclatState
+{
+    int min_support_count;
+    vector<int> weights;
+    size_t bytes = 0;
+    size_t peak_bytes = 0;
+    vector<uint32_t> prefix;
+    vector<pair<vector<uint32_t>, int>> found;
+};
+
+bool difference_within(const vector<uint32_t> &a, const vector<uint32_t> &b, int limit, const vector<int> &weights,
+                       vector<uint32_t> &out, int &out_weight)
+{
+    out_weight = 0;
+    if (limit < 0)
+        return false;
+    size_t i = 0, j = 0;
+    while (i < a.size())
+    {
+        if (j == b.size() || a[i] < b[j])
+        {
+            out_weight += weights[a[i]];
+            if (out_weight > limit)
+                return false;
+            out.push_back(a[i++]);
+        }
+        else if (a[i] == b[j])
+        {
+            ++i;
+            ++j;
+        }
+        else
+            ++j;
+    }
+    return true;
+}
+
+bool intersect_at_least(const vector<uint32_t> &a, int a_weight, const vector<uint32_t> &b, int b_weight, int needed,
+                        const vector<int> &weights, vector<uint32_t> &out, int &out_weight)
+{
+    out_weight = 0;
+    out.reserve(min(a.size(), b.size()));
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (out_weight + min(a_weight, b_weight) < needed)
+            return false;
+        if (a[i] < b[j])
+            a_weight -= weights[a[i++]];
+        else if (b[j] < a[i])
+            b_weight -= weights[b[j++]];
+        else
+        {
+            int w = weights[a[i]];
+            out.push_back(a[i]);
+            out_weight += w;
+            a_weight -= w;
+            b_weight -= w;
+            ++i;
+            ++j;
+        }
+    }
+    return out_weight >= needed;
+}
+
+void mine_eclat_class(vector<EclatMember> &members, bool diffsets, EclatState &state)
+{
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        const EclatMember &parent = members[i];
+        state.prefix.push_back(parent.item);
+        vector<EclatMember> next;
+        size_t tid_total = 0, diff_total = 0;
+        for (size_t j = i + 1; j < members.size(); ++j)
+        {
+            const EclatMember &sibling = members[j];
+            EclatMember member{sibling.item, 0, 0, {}};
+            if (diffsets)
+            {
+                if (!difference_within(sibling.tids, parent.tids, parent.support - state.min_support_count,
+                                       state.weights, member.tids, member.weight))
+                    continue;
+                member.support = parent.support - member.weight;
+            }
+            else
+            {
+                if (!intersect_at_least(parent.tids, parent.weight, sibling.tids, sibling.weight,
+                                        state.min_support_count, state.weights, member.tids, member.weight))
+                    continue;
+                member.support = member.weight;
+            }
+            if (member.support < state.min_support_count)
+                continue;
+
+            vector<uint32_t> itemset = state.prefix;
+            itemset.push_back(member.item);
+            state.found.push_back({itemset, member.support});
+            tid_total += member.tids.size();
+            diff_total += parent.tids.size() - member.tids.size();
+            next.push_back(move(member));
+        }
+
+        bool next_diffsets = diffsets;
+        if (!diffsets && next.size() > 1 && diff_total < tid_total)
+        {
+            for (auto &member : next)
+            {
+                vector<uint32_t> diffset;
+                set_difference(parent.tids.begin(), parent.tids.end(), member.tids.begin(), member.tids.end(),
+                               back_inserter(diffset));
+                member.tids.swap(diffset);
+                member.weight = parent.support - member.support;
+            }
+            next_diffsets = true;
+        }
+
+        for (const auto &member : next)
+            state.bytes += member.tids.size() * sizeof(uint32_t);
+        state.peak_bytes = max(state.peak_bytes, state.bytes);
+        if (next.size() > 1)
+            mine_eclat_class(next, next_diffsets, state);
+        for (const auto &member : next)
+            state.bytes -= member.tids.size() * sizeof(uint32_t);
+        state.prefix.pop_back();
+    }
+}
+
+void mine_eclat(const Transactions &transactions, size_t item_count, int min_support_count,
+                vector<pair<vector<uint32_t>, int>> &all_frequent, ostream &log)
+{
+    EclatState state;
+    state.min_support_count = min_support_count;
+    state.weights = transactions.weights;
+
+    vector<EclatMember> members(item_count);
+    for (uint32_t id = 0; id < item_count; ++id)
+        members[id].item = id;
+    TransactionCursor cursor(transactions);
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        cursor.next();
+        for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+        {
+            members[*item].tids.push_back((uint32_t)t);
+            members[*item].weight += cursor.weight();
+        }
+    }
+    for (auto &member : members)
+        member.support = member.weight;
+    members.erase(remove_if(members.begin(), members.end(),
+                            [&](const EclatMember &member) { return member.support < min_support_count; }),
+                  members.end());
+    for (const auto &member : members)
+        state.bytes += member.tids.size() * sizeof(uint32_t);
+    mine_eclat_class(members, false, state);
+    log << "Eclat: peak tidset/diffset memory " << state.peak_bytes / 1024 << " KB" << endl;
+    append_by_level(state.found, all_frequent, log);
+}
+
+int mine_top_k(const Transactions &transactions, ItemsetIndex frequent_itemsets, size_t top_k, int min_support_count,
+               int threads, vector<pair<vector<uint32_t>, int>> &all_frequent)
+{
+    priority_queue<int, vector<int>, greater<int>> best;
+    int threshold = max(min_support_count, 1);
+    vector<vector<pair<vector<uint32_t>, int>>> levels;
+    for (int k = 2; !frequent_itemsets.empty(); ++k)
+    {
+        ItemsetIndex candidates = generate_candidates(frequent_itemsets, threads);
+        if (candidates.empty())
+            break;
+
+        CandidateTrie trie(candidates);
+        size_t tested = 0;
+        vector<int> candidate_counts = count_candidates(trie, transactions, candidates.size(), threads, tested);
+        for (int count : candidate_counts)
+        {
+            if (count < threshold)
+                continue;
+            best.push(count);
+            if (best.size() > top_k)
+                best.pop();
+            if (best.size() == top_k)
+                threshold = max(threshold, best.top());
+        }
+
+        levels.emplace_back();
+        ItemsetIndex new_frequent(k);
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            if (candidate_counts[c] >= threshold)
+            {
+                new_frequent.insert(candidates[c]);
+                levels.back().push_back({candidates.itemset(c), candidate_counts[c]});
+            }
+        }
+        cout << "Candidate " << k << "-itemsets: " << candidates.size() << ", threshold now " << threshold
+             << " transactions" << endl;
+        frequent_itemsets = move(new_frequent);
+    }
+
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        size_t frequent = 0;
+        for (auto &pair : levels[level])
+        {
+            if (pair.second >= threshold)
+            {
+                all_frequent.push_back(move(pair));
+                frequent++;
+            }
+        }
+        if (frequent == 0)
+            break;
+        cout << "Frequent " << level + 2 << "-itemsets: " << frequent << endl;
+    }
+    return threshold;
+}
+
+void mine_frequent(const string &algo, const Transactions &transactions, const ItemsetIndex &frequent_itemsets,
+                   size_t item_count, int min_support_count, int threads,
+                   vector<pair<vector<uint32_t>, int>> &all_frequent, ostream &log)
+{
+    if (algo == "eclat")
+        mine_eclat(transactions, item_count, min_support_count, all_frequent, log);
+    else if (algo == "fpgrowth")
+        mine_fpgrowth(transactions, item_count, min_support_count, all_frequent, log);
+    else if (algo == "vertical")
+        mine_vertical(transactions, frequent_itemsets, min_support_count, threads, all_frequent, log);
+    else
+        mine_apriori(transactions, frequent_itemsets, min_support_count, threads, all_frequent, log);
+}
+
+ItemsetIndex frequent_items(const Transactions &transactions, size_t item_count, int min_support_count)
+{
+    vector<int> supports(item_count, 0);
+    TransactionCursor cursor(transactions);
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        cursor.next();
+        for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+            supports[*item] += cursor.weight();
+    }
+    ItemsetIndex items(1);
+    for (uint32_t id = 0; id < supports.size(); ++id)
+    {
+        if (supports[id] >= min_support_count)
+            items.insert(&id);
+    }
+    return items;
+}
 
-    if (!file.is_open())
+vector<vector<int>> count_in_file(const string &filename, int threads, const unordered_map<string, uint32_t> &item_ids,
+                                  const vector<ItemsetIndex> &levels, size_t chunk_bytes, size_t *rows = nullptr)
+{
+    vector<CandidateTrie> tries;
+    vector<vector<int>> counts;
+    for (const auto &level : levels)
     {
-        cerr << "Error: Cannot open file " << filename << endl;
-        return transactions;
+        tries.emplace_back(level);
+        counts.emplace_back(level.size(), 0);
     }
 
-    vector<string> item_names;
-    if (getline(file, line))
+    TransactionReader reader;
+    Transactions chunk;
+    reader.open(filename, threads, item_ids);
+    while (reader.read(chunk, chunk_bytes))
+    {
+        if (rows)
+            *rows += chunk.rows;
+        for (size_t k = 0; k < levels.size(); ++k)
+        {
+            if (levels[k].empty())
+                continue;
+            if (levels[k].itemsetSize() == 1)
+            {
+                TransactionCursor cursor(chunk);
+                for (size_t t = 0; t < chunk.size(); ++t)
+                {
+                    cursor.next();
+                    for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+                    {
+                        uint32_t id = levels[k].find(item);
+                        if (id != ItemsetIndex::npos)
+                            counts[k][id] += cursor.weight();
+                    }
+                }
+                continue;
+            }
+            size_t tested = 0;
+            vector<int> partial = count_candidates(tries[k], chunk, counts[k].size(), threads, tested);
+            for (size_t c = 0; c < partial.size(); ++c)
+                counts[k][c] += partial[c];
+        }
+    }
+    return counts;
+}
+
+void mine_partitioned(const string &algo, const string &filename, const unordered_map<string, uint32_t> &item_ids,
+                      double min_support_percent, int min_support_count, size_t budget_bytes, int threads,
+                      vector<pair<vector<uint32_t>, int>> &all_frequent)
+{
+    size_t chunk_bytes = max<size_t>(budget_bytes / 4, 1 << 16);
+    vector<ItemsetIndex> candidates;
+    TransactionReader reader;
+    Transactions chunk;
+    ostream quiet(nullptr);
+
+    reader.open(filename, threads, item_ids);
+    size_t partitions = 0;
+    while (reader.read(chunk, chunk_bytes))
     {
-        stringstream header_ss(line);
-        string header_item;
+        int local_min = max(1, (int)ceil(min_support_percent / 100.0 * chunk.rows - 1e-9));
+        ItemsetIndex local_items = frequent_items(chunk, item_ids.size(), local_min);
 
-        while (getline(header_ss, header_item, ','))
+        vector<pair<vector<uint32_t>, int>> local;
+        mine_frequent(algo, chunk, local_items, item_ids.size(), local_min, threads, local, quiet);
+        for (const auto &pair : local)
         {
-            item_names.push_back(trim(header_item));
+            size_t k = pair.first.size();
+            if (k < 2)
+                continue;
+            while (candidates.size() < k + 1)
+                candidates.emplace_back(candidates.size());
+            candidates[k].insert(pair.first);
         }
+        cout << "Partition " << ++partitions << ": " << chunk.rows << " transactions, local minimum " << local_min
+             << ", " << local.size() << " local itemsets" << endl;
     }
 
-    int transaction_count = 0;
-    while (getline(file, line))
+    size_t total = 0;
+    for (size_t k = 2; k < candidates.size(); ++k)
     {
-        if (line.empty())
-            continue;
+        vector<vector<uint32_t>> sorted;
+        for (size_t c = 0; c < candidates[k].size(); ++c)
+            sorted.push_back(candidates[k].itemset(c));
+        sort(sorted.begin(), sorted.end());
+        candidates[k].reset(k, sorted.size());
+        for (const auto &itemset : sorted)
+            candidates[k].insert(itemset);
+        total += sorted.size();
+    }
+    cout << "Partition candidates: " << total << " itemsets verified in a second pass" << endl;
 
-        vector<string> transaction_items;
-        stringstream ss(line);
-        string cell;
+    vector<vector<int>> counts = count_in_file(filename, threads, item_ids, candidates, chunk_bytes);
 
-        int item_index = 0;
-        while (getline(ss, cell, ','))
+    for (size_t k = 2; k < candidates.size(); ++k)
+    {
+        size_t frequent = 0;
+        for (size_t c = 0; c < candidates[k].size(); ++c)
         {
-            string trimmed_cell = trim(cell);
-            if (trimmed_cell == "1" && item_index < item_names.size())
+            if (counts[k][c] >= min_support_count)
             {
-                transaction_items.push_back(item_names[item_index]);
+                all_frequent.push_back({candidates[k].itemset(c), counts[k][c]});
+                frequent++;
             }
-            item_index++;
         }
+        if (frequent == 0)
+            break;
+        cout << "Frequent " << k << "-itemsets: " << frequent << endl;
+    }
+}
+
+int mine_sampled(const string &algo, const string &filename, double min_support_percent, double fraction,
+                 size_t chunk_bytes, int threads, vector<string> &item_names,
+                 vector<pair<vector<uint32_t>, int>> &all_frequent, vector<pair<double, double>> &intervals)
+{
+    const double z = 1.96;
+    TransactionReader reader;
+    if (!reader.open(filename, threads, {}, fraction))
+    {
+        cerr << "Error: Cannot open file " << filename << endl;
+        return 0;
+    }
+    item_names = reader.item_names();
+    unordered_map<string, uint32_t> item_ids;
+    for (uint32_t id = 0; id < item_names.size(); ++id)
+        item_ids[item_names[id]] = id;
+    reader.map_items(item_ids);
+
+    Transactions sample;
+    vector<int> sample_items(item_names.size(), 0);
+    if (reader.read(sample))
+    {
+        TransactionCursor cursor(sample);
+        for (size_t t = 0; t < sample.size(); ++t)
+        {
+            cursor.next();
+            for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+                sample_items[*item] += cursor.weight();
+        }
+    }
 
-        if (!transaction_items.empty())
+    double n = (double)max<size_t>(sample.rows, 1), p = min_support_percent / 100.0;
+    double lowered = max(0.0, p - z * sqrt(p * (1.0 - p) / n));
+    int sample_min = max(1, (int)floor(lowered * n));
+    cout << "Sample: " << sample.rows << " transactions, lowered support " << lowered * 100.0 << "% (" << sample_min
+         << " sampled transactions)" << endl;
+
+    vector<ItemsetIndex> levels(2, ItemsetIndex(1));
+    vector<vector<int>> sample_counts(2);
+    for (uint32_t id = 0; id < item_names.size(); ++id)
+    {
+        if (sample_items[id] >= sample_min)
+        {
+            levels[1].insert(&id);
+            sample_counts[1].push_back(sample_items[id]);
+        }
+    }
+    vector<pair<vector<uint32_t>, int>> local;
+    ostream quiet(nullptr);
+    if (!levels[1].empty())
+        mine_frequent(algo, sample, levels[1], item_names.size(), sample_min, threads, local, quiet);
+    sort(local.begin(), local.end(), [](const pair<vector<uint32_t>, int> &a, const pair<vector<uint32_t>, int> &b) {
+        return a.first.size() != b.first.size() ? a.first.size() < b.first.size() : a.first < b.first;
+    });
+    for (const auto &pair : local)
+    {
+        size_t k = pair.first.size();
+        if (k < 2)
+            continue;
+        while (levels.size() <= k)
         {
-            sort(transaction_items.begin(), transaction_items.end());
-            transactions.push_back(transaction_items);
-            transaction_count++;
+            levels.emplace_back(levels.size());
+            sample_counts.emplace_back();
         }
+        levels[k].insert(pair.first);
+        sample_counts[k].push_back(pair.second);
     }
 
-    file.close();
-    cout << "Processed " << transaction_count << " transactions with " << item_names.size() << " items" << endl;
-    return transactions;
+    vector<ItemsetIndex> checked(2, ItemsetIndex(1));
+    for (uint32_t id = 0; id < item_names.size(); ++id)
+        checked[1].insert(&id);
+    for (size_t k = 2; k <= levels.size() && !levels[k - 1].empty(); ++k)
+        checked.push_back(generate_candidates(levels[k - 1], threads));
+
+    size_t rows = 0;
+    vector<vector<int>> counts = count_in_file(filename, threads, item_ids, checked, chunk_bytes, &rows);
+    int num_transactions = (int)rows;
+    if (num_transactions == 0)
+        return 0;
+    int min_support_count = max(1, (int)ceil(p * num_transactions));
+    cout << "Processed " << num_transactions << " transactions with " << item_names.size() << " items" << endl;
+    cout << "Minimum support: " << min_support_percent << "% (" << min_support_count << " transactions)" << endl;
+
+    size_t sampled = 0, border = 0, missed = 0;
+    for (size_t k = 1; k < checked.size(); ++k)
+    {
+        size_t frequent = 0;
+        for (size_t c = 0; c < checked[k].size(); ++c)
+        {
+            uint32_t id = k < levels.size() ? levels[k].find(checked[k][c]) : ItemsetIndex::npos;
+            if (id == ItemsetIndex::npos)
+            {
+                border++;
+                missed += counts[k][c] >= min_support_count;
+                continue;
+            }
+            sampled++;
+            if (counts[k][c] < min_support_count)
+                continue;
+            double q = sample_counts[k][id] / n, centre = (q + z * z / (2 * n)) / (1 + z * z / n);
+            double spread = z * sqrt(q * (1 - q) / n + z * z / (4 * n * n)) / (1 + z * z / n);
+            all_frequent.push_back({checked[k].itemset(c), counts[k][c]});
+            intervals.push_back({max(0.0, centre - spread), min(1.0, centre + spread)});
+            frequent++;
+        }
+        if (frequent)
+            cout << "Frequent " << k << "-itemsets: " << frequent << endl;
+    }
+    cout << "Verified " << sampled << " sampled itemsets and a negative border of " << border << " in one pass, "
+         << missed << " border itemsets frequent" << endl;
+    if (missed == 0)
+        return num_transactions;
+
+    cout << "The sample missed frequent itemsets, mining the full data instead" << endl;
+    all_frequent.clear();
+    intervals.clear();
+    unordered_map<string, uint32_t> frequent_ids;
+    ItemsetIndex frequent_itemsets(1);
+    for (uint32_t id = 0; id < item_names.size(); ++id)
+    {
+        if (counts[1][id] < min_support_count)
+            continue;
+        frequent_ids[item_names[id]] = id;
+        frequent_itemsets.insert(&id);
+        all_frequent.push_back({{id}, counts[1][id]});
+    }
+    if (chunk_bytes != SIZE_MAX)
+        mine_partitioned(algo, filename, frequent_ids, min_support_percent, min_support_count, chunk_bytes * 4, threads,
+                         all_frequent);
+    else
+    {
+        Transactions transactions = read_transactions(filename, threads, frequent_ids);
+        mine_frequent(algo, transactions, frequent_itemsets, item_names.size(), min_support_count, threads,
+                      all_frequent, cout);
+    }
+    return num_transactions;
 }
 
-string create_itemset_key(const vector<string> &itemset)
+struct MiningState
 {
-    string key;
-    for (size_t i = 0; i < itemset.size(); ++i)
+    double support_percent = 0.0;
+    int transactions = 0;
+    vector<string> files;
+    vector<string> items;
+    vector<int> item_counts;
+    vector<pair<vector<uint32_t>, int>> itemsets;
+
+    bool load(const string &filename)
+    {
+        ifstream in(filename);
+        string line;
+        size_t n = 0;
+        if (!getline(in, line) || line != "apriori_state 1")
+            return false;
+        in >> line >> support_percent >> line >> transactions >> line >> n;
+        getline(in, line);
+        files.resize(n);
+        for (auto &file : files)
+            getline(in, file);
+        in >> line >> n;
+        getline(in, line);
+        items.resize(n);
+        item_counts.resize(n);
+        for (size_t i = 0; i < n && getline(in, line); ++i)
+        {
+            size_t tab = line.rfind('\t');
+            items[i] = line.substr(0, tab);
+            item_counts[i] = atoi(line.c_str() + tab + 1);
+        }
+        in >> line >> n;
+        getline(in, line);
+        itemsets.resize(n);
+        for (auto &itemset : itemsets)
+        {
+            getline(in, line);
+            istringstream fields(line);
+            uint32_t item;
+            fields >> itemset.second;
+            while (fields >> item)
+                itemset.first.push_back(item);
+        }
+        return !in.fail();
+    }
+
+    bool save(const string &filename) const
     {
-        if (i > 0)
-            key += "|";
-        key += itemset[i];
+        string tmp_file = filename + ".tmp";
+        if (!write(tmp_file))
+        {
+            remove(tmp_file.c_str());
+            return false;
+        }
+        if (rename(tmp_file.c_str(), filename.c_str()) == 0)
+            return true;
+        remove(filename.c_str());
+        return rename(tmp_file.c_str(), filename.c_str()) == 0;
     }
-    return key;
-}
 
-vector<vector<string>> generate_candidates(const vector<vector<string>> &frequent_sets)
+    bool write(const string &filename) const
+    {
+        ofstream out(filename);
+        out << "apriori_state 1\n" << setprecision(17) << "support_percent " << support_percent << "\n";
+        out << "transactions " << transactions << "\nfiles " << files.size() << "\n";
+        for (const auto &file : files)
+            out << file << "\n";
+        out << "items " << items.size() << "\n";
+        for (size_t i = 0; i < items.size(); ++i)
+            out << items[i] << "\t" << item_counts[i] << "\n";
+        out << "itemsets " << itemsets.size() << "\n";
+        for (const auto &itemset : itemsets)
+        {
+            out << itemset.second;
+            for (uint32_t item : itemset.first)
+                out << " " << item;
+            out << "\n";
+        }
+        return out.good();
+    }
+};
+
+bool update_state(const string &state_file, const string &batch_file, const unordered_map<string, int> &batch_counts,
+                  int batch_rows, double min_support_percent, int threads, size_t chunk_bytes, vector<string> &item_names,
+                  vector<pair<vector<uint32_t>, int>> &all_frequent, int &num_transactions)
 {
-    vector<vector<string>> candidates;
-    int n = frequent_sets.size();
-    if (n == 0)
-        return candidates;
+    MiningState state;
+    if (ifstream(state_file).good() && !state.load(state_file))
+    {
+        cerr << "Error: Cannot parse mining state " << state_file << endl;
+        return false;
+    }
+    if (!state.files.empty() && fabs(state.support_percent - min_support_percent) > 1e-9)
+    {
+        cerr << "Error: Mining state was built at " << state.support_percent << "% support" << endl;
+        return false;
+    }
+    string batch_path = filesystem::absolute(batch_file).lexically_normal().string();
+    if (find(state.files.begin(), state.files.end(), batch_path) != state.files.end())
+    {
+        cerr << "Error: " << batch_file << " is already part of the mining state" << endl;
+        return false;
+    }
+    for (const auto &file : state.files)
+    {
+        if (!ifstream(file).good())
+        {
+            cerr << "Error: Cannot open history file " << file << endl;
+            return false;
+        }
+    }
 
-    int k = frequent_sets[0].size() + 1;
-    unordered_set<string> frequent_set_keys;
+    item_names = state.items;
+    for (const auto &pair : batch_counts)
+        item_names.push_back(pair.first);
+    sort(item_names.begin(), item_names.end());
+    item_names.erase(unique(item_names.begin(), item_names.end()), item_names.end());
+    vector<int> counts(item_names.size(), 0);
+    vector<uint32_t> remap(state.items.size());
+    for (size_t i = 0; i < state.items.size(); ++i)
+    {
+        remap[i] = (uint32_t)(lower_bound(item_names.begin(), item_names.end(), state.items[i]) - item_names.begin());
+        counts[remap[i]] += state.item_counts[i];
+    }
+    for (const auto &pair : batch_counts)
+        counts[lower_bound(item_names.begin(), item_names.end(), pair.first) - item_names.begin()] += pair.second;
+
+    num_transactions = state.transactions + batch_rows;
+    int min_support_count = max(1, (int)ceil((min_support_percent / 100.0) * num_transactions));
+    cout << "Incremental update: " << state.transactions << " + " << batch_rows << " transactions, minimum support "
+         << min_support_count << " transactions" << endl;
+
+    vector<ItemsetIndex> known;
+    vector<vector<int>> known_counts;
+    for (const auto &pair : state.itemsets)
+    {
+        size_t k = pair.first.size();
+        while (known.size() <= k)
+        {
+            known.emplace_back(known.size());
+            known_counts.emplace_back();
+        }
+        vector<uint32_t> itemset;
+        for (uint32_t item : pair.first)
+            itemset.push_back(remap[item]);
+        known[k].insert(itemset);
+        known_counts[k].push_back(pair.second);
+    }
 
-    for (const auto &set : frequent_sets)
+    unordered_map<string, uint32_t> item_ids;
+    ItemsetIndex frequent_itemsets(1);
+    for (uint32_t id = 0; id < item_names.size(); ++id)
     {
-        frequent_set_keys.insert(create_itemset_key(set));
+        if (counts[id] < min_support_count)
+            continue;
+        item_ids[item_names[id]] = id;
+        frequent_itemsets.insert(&id);
+        all_frequent.push_back({{id}, counts[id]});
     }
+    cout << "Frequent 1-itemsets: " << frequent_itemsets.size() << endl;
+    Transactions batch = read_transactions(batch_file, threads, item_ids);
 
-    for (int i = 0; i < n; ++i)
+    MiningState updated;
+    size_t border = 0, rescans = 0;
+    for (size_t k = 2; !frequent_itemsets.empty(); ++k)
     {
-        for (int j = i + 1; j < n; ++j)
+        ItemsetIndex candidates = generate_candidates(frequent_itemsets, threads);
+        if (candidates.empty())
+            break;
+        CandidateTrie trie(candidates);
+        size_t tested = 0;
+        vector<int> candidate_counts = count_candidates(trie, batch, candidates.size(), threads, tested);
+
+        vector<ItemsetIndex> unknown(k + 1);
+        unknown[k].reset(k);
+        vector<size_t> unknown_positions;
+        for (size_t c = 0; c < candidates.size(); ++c)
         {
-            bool can_join = true;
-            for (int p = 0; p < k - 2; ++p)
+            uint32_t id = k < known.size() ? known[k].find(candidates[c]) : ItemsetIndex::npos;
+            if (id != ItemsetIndex::npos)
+                candidate_counts[c] += known_counts[k][id];
+            else
             {
-                if (frequent_sets[i][p] != frequent_sets[j][p])
-                {
-                    can_join = false;
-                    break;
-                }
+                unknown[k].insert(candidates[c]);
+                unknown_positions.push_back(c);
             }
-            if (!can_join)
-                continue;
-
-            vector<string> candidate = frequent_sets[i];
-            candidate.push_back(frequent_sets[j].back());
-
-            bool is_valid = true;
-            for (int idx = 0; idx < k; ++idx)
+        }
+        if (!unknown_positions.empty() && !state.files.empty())
+        {
+            for (const auto &file : state.files)
             {
-                vector<string> subset;
-                for (int t = 0; t < k; ++t)
-                {
-                    if (t != idx)
-                        subset.push_back(candidate[t]);
-                }
-                if (frequent_set_keys.find(create_itemset_key(subset)) == frequent_set_keys.end())
-                {
-                    is_valid = false;
-                    break;
-                }
+                vector<vector<int>> history = count_in_file(file, threads, item_ids, unknown, chunk_bytes);
+                for (size_t u = 0; u < unknown_positions.size(); ++u)
+                    candidate_counts[unknown_positions[u]] += history[k][u];
             }
+            rescans++;
+        }
 
-            if (is_valid)
+        ItemsetIndex new_frequent(k);
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            updated.itemsets.push_back({candidates.itemset(c), candidate_counts[c]});
+            if (candidate_counts[c] >= min_support_count)
             {
-                candidates.push_back(candidate);
+                new_frequent.insert(candidates[c]);
+                all_frequent.push_back({candidates.itemset(c), candidate_counts[c]});
             }
+            else
+                border++;
         }
+        if (new_frequent.empty())
+            break;
+        cout << "Frequent " << k << "-itemsets: " << new_frequent.size() << endl;
+        frequent_itemsets = move(new_frequent);
     }
-    return candidates;
+
+    updated.support_percent = min_support_percent;
+    updated.transactions = num_transactions;
+    updated.files = state.files;
+    updated.files.push_back(batch_path);
+    updated.items = item_names;
+    updated.item_counts = counts;
+    if (!updated.save(state_file))
+    {
+        cerr << "Error: Cannot write mining state " << state_file << endl;
+        return false;
+    }
+    cout << "State: " << updated.files.size() << " batches, " << border << " border itemsets, history rescanned for "
+         << rescans << " levels -> " << state_file << endl;
+    return true;
 }
 
-bool contains_itemset(const vector<string> &transaction, const vector<string> &itemset)
+vector<bool> condensed_itemsets(const vector<pair<vector<uint32_t>, int>> &all_frequent, bool maximal)
 {
-    size_t i = 0, j = 0;
-    while (i < transaction.size() && j < itemset.size())
+    vector<ItemsetIndex> levels;
+    vector<vector<size_t>> positions;
+    for (size_t i = 0; i < all_frequent.size(); ++i)
     {
-        if (transaction[i] < itemset[j])
+        size_t k = all_frequent[i].first.size();
+        while (levels.size() <= k)
         {
-            ++i;
+            levels.emplace_back(levels.size());
+            positions.emplace_back();
         }
-        else if (transaction[i] == itemset[j])
+        if (levels[k].insert(all_frequent[i].first) == positions[k].size())
+            positions[k].push_back(i);
+    }
+
+    vector<bool> keep(all_frequent.size(), true);
+    vector<uint32_t> subset;
+    for (size_t k = 2; k < levels.size(); ++k)
+    {
+        for (size_t i = 0; i < levels[k].size(); ++i)
         {
-            ++i;
-            ++j;
+            const uint32_t *itemset = levels[k][i];
+            int count = all_frequent[positions[k][i]].second;
+            subset.resize(k - 1);
+            for (size_t drop = 0; drop < k; ++drop)
+            {
+                copy(itemset, itemset + drop, subset.begin());
+                copy(itemset + drop + 1, itemset + k, subset.begin() + drop);
+                uint32_t id = levels[k - 1].find(subset);
+                if (id != ItemsetIndex::npos && (maximal || all_frequent[positions[k - 1][id]].second == count))
+                    keep[positions[k - 1][id]] = false;
+            }
         }
-        else
+    }
+    return keep;
+}
+
+void condense_results(vector<pair<vector<uint32_t>, int>> &all_frequent, vector<pair<double, double>> &intervals,
+                      bool maximal)
+{
+    vector<bool> keep = condensed_itemsets(all_frequent, maximal);
+    size_t kept = 0;
+    for (size_t i = 0; i < all_frequent.size(); ++i)
+    {
+        if (!keep[i])
+            continue;
+        if (kept != i)
         {
-            return false;
+            all_frequent[kept] = move(all_frequent[i]);
+            if (!intervals.empty())
+                intervals[kept] = intervals[i];
         }
+        kept++;
     }
-    return j == itemset.size();
+    cout << (maximal ? "Maximal" : "Closed") << " itemsets: " << kept << " of " << all_frequent.size() << endl;
+    all_frequent.resize(kept);
+    if (!intervals.empty())
+        intervals.resize(kept);
 }
 
-void write_results(const vector<pair<vector<string>, int>> &all_frequent,
-                   int num_transactions, const string &input_file)
+void write_results(const vector<pair<vector<uint32_t>, int>> &all_frequent, const vector<string> &item_names,
+                   int num_transactions, const string &input_file,
+                   const vector<pair<double, double>> &intervals = vector<pair<double, double>>())
 {
     string output_file = input_file;
     size_t last_slash = output_file.find_last_of("/\\");
@@ -202,123 +1553,349 @@ void write_results(const vector<pair<vector<string>, int>> &all_frequent,
         return;
     }
 
-    output << "itemset,count,support_percent\n";
-    for (const auto &pair : all_frequent)
+    output << "itemset,count,support_percent" << (intervals.empty() ? "" : ",ci_low_percent,ci_high_percent") << "\n";
+    for (size_t i = 0; i < all_frequent.size(); ++i)
     {
-        const vector<string> &itemset = pair.first;
+        const auto &pair = all_frequent[i];
+        const vector<uint32_t> &itemset = pair.first;
         int count = pair.second;
         output << "\"";
         for (size_t j = 0; j < itemset.size(); ++j)
         {
             if (j > 0)
                 output << ",";
-            output << itemset[j];
+            output << item_names[itemset[j]];
         }
-        output << "\"," << count << "," << (100.0 * count / num_transactions) << "\n";
+        output << "\"," << count << "," << (100.0 * count / num_transactions);
+        if (!intervals.empty())
+            output << "," << 100.0 * intervals[i].first << "," << 100.0 * intervals[i].second;
+        output << "\n";
     }
     output.close();
     cout << "Results written to " << output_file << endl;
 }
 
+bool mine_stream(const string &algo, const string &input, double min_support_percent, double epsilon_percent,
+                 size_t snapshot_every, int threads)
+{
+    TransactionReader reader;
+    if (!reader.open(input, threads, {}))
+    {
+        cerr << "Error: Cannot open " << input << endl;
+        return false;
+    }
+    vector<string> item_names = reader.item_names();
+    unordered_map<string, uint32_t> item_ids;
+    for (uint32_t id = 0; id < item_names.size(); ++id)
+        item_ids[item_names[id]] = id;
+    reader.map_items(item_ids);
+
+    size_t width = (size_t)ceil(100.0 / epsilon_percent);
+    size_t batch_rows = width * max<size_t>(1, snapshot_every / width);
+    string output = input == "-" ? "stdin" : input;
+    cout << "Streaming from " << (input == "-" ? "standard input" : input) << ": " << item_names.size()
+         << " items, buckets of " << width << " transactions, snapshots every " << batch_rows << endl;
+
+    vector<ItemsetIndex> levels;
+    vector<vector<int>> counts, deltas;
+    long long total = 0, bucket = 0;
+    Transactions chunk;
+    ostream quiet(nullptr);
+    while (reader.read(chunk, SIZE_MAX, batch_rows))
+    {
+        total += chunk.rows;
+        long long current = (total + width - 1) / width;
+        int beta = (int)max<long long>(1, current - bucket);
+        bucket = current;
+
+        vector<int> supports(item_names.size(), 0);
+        TransactionCursor cursor(chunk);
+        for (size_t t = 0; t < chunk.size(); ++t)
+        {
+            cursor.next();
+            for (const uint32_t *item = cursor.begin(); item != cursor.end(); ++item)
+                supports[*item] += cursor.weight();
+        }
+        vector<vector<int>> batch_counts(levels.size());
+        for (size_t k = 1; k < levels.size(); ++k)
+        {
+            if (k == 1)
+            {
+                for (size_t e = 0; e < levels[1].size(); ++e)
+                    batch_counts[1].push_back(supports[levels[1][e][0]]);
+                continue;
+            }
+            size_t tested = 0;
+            batch_counts[k] = count_candidates(CandidateTrie(levels[k]), chunk, levels[k].size(), threads, tested);
+        }
+
+        vector<pair<vector<uint32_t>, int>> local;
+        ItemsetIndex batch_items(1);
+        for (uint32_t id = 0; id < supports.size(); ++id)
+        {
+            if (supports[id] >= beta)
+            {
+                batch_items.insert(&id);
+                local.push_back({{id}, supports[id]});
+            }
+        }
+        mine_frequent(algo, chunk, batch_items, item_names.size(), beta, threads, local, quiet);
+
+        vector<vector<tuple<vector<uint32_t>, int, int>>> entries(levels.size());
+        for (size_t k = 1; k < levels.size(); ++k)
+        {
+            for (size_t e = 0; e < levels[k].size(); ++e)
+            {
+                int count = counts[k][e] + batch_counts[k][e];
+                if (count + deltas[k][e] > current)
+                    entries[k].emplace_back(levels[k].itemset(e), count, deltas[k][e]);
+            }
+        }
+        for (auto &pair : local)
+        {
+            size_t k = pair.first.size();
+            if (k < levels.size() && levels[k].find(pair.first) != ItemsetIndex::npos)
+                continue;
+            while (entries.size() <= k)
+                entries.emplace_back();
+            entries[k].emplace_back(move(pair.first), pair.second, (int)(current - beta));
+        }
+
+        size_t tracked = 0;
+        levels.assign(entries.size(), ItemsetIndex());
+        counts.assign(entries.size(), vector<int>());
+        deltas.assign(entries.size(), vector<int>());
+        for (size_t k = 1; k < entries.size(); ++k)
+        {
+            sort(entries[k].begin(), entries[k].end());
+            levels[k].reset(k, entries[k].size());
+            for (const auto &entry : entries[k])
+            {
+                levels[k].insert(get<0>(entry));
+                counts[k].push_back(get<1>(entry));
+                deltas[k].push_back(get<2>(entry));
+            }
+            tracked += entries[k].size();
+        }
+
+        double reported = (min_support_percent - epsilon_percent) / 100.0 * total;
+        vector<pair<vector<uint32_t>, int>> snapshot;
+        for (size_t k = 1; k < levels.size(); ++k)
+        {
+            for (size_t e = 0; e < levels[k].size(); ++e)
+            {
+                if (counts[k][e] >= reported)
+                    snapshot.push_back({levels[k].itemset(e), counts[k][e]});
+            }
+        }
+        cout << "Stream: " << total << " transactions, " << tracked << " tracked itemsets, " << snapshot.size()
+             << " reported" << endl;
+        write_results(snapshot, item_names, (int)total, output);
+    }
+    return true;
+}
+
 int main(int argc, char **argv)
 {
-    if (argc < 3)
+    int threads = takeThreadsFlag(argc, argv);
+    string algo = "apriori", value;
+    takeFlag(argc, argv, "--algo", algo);
+    double mem_budget_mb = takeFlag(argc, argv, "--mem-budget", value) ? atof(value.c_str()) : 0.0;
+    double sample_fraction = takeFlag(argc, argv, "--sample", value) ? atof(value.c_str()) : 0.0;
+    bool stream = takeSwitch(argc, argv, "--stream");
+    double epsilon_percent = takeFlag(argc, argv, "--epsilon", value) ? atof(value.c_str()) : 0.0;
+    size_t snapshot_every = takeFlag(argc, argv, "--snapshot", value) ? (size_t)max(atol(value.c_str()), 1L) : 10000;
+    string state_file;
+    takeFlag(argc, argv, "--state", state_file);
+    size_t top_k = takeFlag(argc, argv, "--top-k", value) ? (size_t)max(atoi(value.c_str()), 0) : 0;
+    bool closed = takeSwitch(argc, argv, "--closed");
+    bool maximal = takeSwitch(argc, argv, "--maximal");
+    if (threads < 1 || (argc < 3 && !(top_k > 0 && argc == 2)))
     {
-        cout << "Usage: " << argv[0] << " <input_transactions.csv> <min_support_percent>" << endl;
+        cout << "Usage: " << argv[0] << " <input_transactions.csv> <min_support_percent> [--threads N]"
+             << " [--algo apriori|vertical|fpgrowth|eclat] [--mem-budget MB]"
+             << " [--sample fraction] [--closed|--maximal] [--top-k N]"
+             << " [--state FILE] [--stream [--epsilon P] [--snapshot N]]" << endl;
         cout << "Example: " << argv[0] << " transactions.csv 25" << endl;
+        cout << "With --top-k only the N most frequent itemsets of two or more items are written; the support is optional"
+             << " and only sets a floor for the threshold" << endl;
+        cout << "With --state the input is a new batch folded into the saved counts of the earlier batches" << endl;
+        cout << "With --stream the input may be - or a pipe; snapshots approximate support within P percent"
+             << " (default a tenth of the support)" << endl;
         return 1;
     }
 
     string input_file = argv[1];
-    double min_support_percent = stod(argv[2]);
+    double min_support_percent = argc > 2 ? stod(argv[2]) : 0.0;
 
-    if (min_support_percent <= 0 || min_support_percent > 100)
+    if ((min_support_percent <= 0 && top_k == 0) || min_support_percent < 0 || min_support_percent > 100)
     {
         cerr << "Error: Minimum support must be between 0 and 100" << endl;
         return 1;
     }
 
+    if (sample_fraction < 0 || sample_fraction > 1)
+    {
+        cerr << "Error: Sample fraction must be between 0 and 1" << endl;
+        return 1;
+    }
+
+    if (top_k > 0 && (sample_fraction > 0 || mem_budget_mb > 0))
+    {
+        cerr << "Error: --top-k needs the transactions in memory and cannot be combined with --sample or --mem-budget"
+             << endl;
+        return 1;
+    }
+
+    if (!state_file.empty() && (top_k > 0 || sample_fraction > 0))
+    {
+        cerr << "Error: --state keeps exact counts and cannot be combined with --top-k or --sample" << endl;
+        return 1;
+    }
+
+    if (closed && maximal)
+    {
+        cerr << "Error: --closed and --maximal are mutually exclusive" << endl;
+        return 1;
+    }
+
+    if (algo != "apriori" && algo != "vertical" && algo != "fpgrowth" && algo != "eclat")
+    {
+        cerr << "Error: Unknown algorithm " << algo << endl;
+        return 1;
+    }
+
+    if (stream)
+    {
+        if (epsilon_percent <= 0)
+            epsilon_percent = min_support_percent / 10.0;
+        if (epsilon_percent >= min_support_percent || top_k > 0 || sample_fraction > 0 || !state_file.empty() || closed ||
+            maximal)
+        {
+            cerr << "Error: --stream needs --epsilon below the support and cannot be combined with --top-k, --sample,"
+                 << " --state, --closed or --maximal" << endl;
+            return 1;
+        }
+        return mine_stream(algo, input_file, min_support_percent, epsilon_percent, snapshot_every, threads) ? 0 : 1;
+    }
+
     cout << "Reading transactions from: " << input_file << endl;
-    vector<vector<string>> transactions = read_transactions(input_file);
-    if (transactions.empty())
+    if (sample_fraction > 0)
+    {
+        vector<string> item_names;
+        vector<pair<vector<uint32_t>, int>> all_frequent;
+        vector<pair<double, double>> intervals;
+        int num_transactions =
+            mine_sampled(algo, input_file, min_support_percent, sample_fraction,
+                         mem_budget_mb > 0 ? (size_t)(mem_budget_mb * 1024 * 1024 / 4) : SIZE_MAX, threads, item_names,
+                         all_frequent, intervals);
+        if (num_transactions == 0)
+        {
+            cerr << "Error: No transactions found or error reading file" << endl;
+            return 1;
+        }
+        if (closed || maximal)
+            condense_results(all_frequent, intervals, maximal);
+        write_results(all_frequent, item_names, num_transactions, input_file, intervals);
+        return 0;
+    }
+
+    unordered_map<string, int> item_counts;
+    int num_transactions = count_items(input_file, threads, item_counts);
+    if (num_transactions == 0)
     {
         cerr << "Error: No transactions found or error reading file" << endl;
         return 1;
     }
 
-    int num_transactions = transactions.size();
-    int min_support_count = ceil((min_support_percent / 100.0) * num_transactions);
+    if (!state_file.empty())
+    {
+        vector<string> item_names;
+        vector<pair<vector<uint32_t>, int>> all_frequent;
+        vector<pair<double, double>> intervals;
+        if (!update_state(state_file, input_file, item_counts, num_transactions, min_support_percent, threads,
+                          mem_budget_mb > 0 ? (size_t)(mem_budget_mb * 1024 * 1024 / 4) : SIZE_MAX, item_names,
+                          all_frequent, num_transactions))
+            return 1;
+        if (closed || maximal)
+            condense_results(all_frequent, intervals, maximal);
+        write_results(all_frequent, item_names, num_transactions, input_file);
+        return 0;
+    }
+
+    int min_support_count = max(1, (int)ceil((min_support_percent / 100.0) * num_transactions));
 
     cout << "Minimum support: " << min_support_percent << "% (" << min_support_count << " transactions)" << endl;
 
-    unordered_map<string, int> item_counts;
-    for (const auto &transaction : transactions)
+    vector<string> item_names;
+    for (const auto &pair : item_counts)
     {
-        for (const auto &item : transaction)
-        {
-            item_counts[item]++;
-        }
+        if (pair.second >= min_support_count)
+            item_names.push_back(pair.first);
     }
+    sort(item_names.begin(), item_names.end());
+    unordered_map<string, uint32_t> item_ids;
+    for (uint32_t id = 0; id < item_names.size(); id++)
+        item_ids[item_names[id]] = id;
 
-    vector<vector<string>> frequent_itemsets;
-    vector<pair<vector<string>, int>> all_frequent;
+    ItemsetIndex frequent_itemsets(1);
+    vector<pair<vector<uint32_t>, int>> all_frequent;
 
     // frequent 1-itemsets
+    for (uint32_t id = 0; id < item_names.size(); id++)
+        frequent_itemsets.insert(&id);
     for (const auto &pair : item_counts)
     {
         if (pair.second >= min_support_count)
-        {
-            vector<string> single_item = {pair.first};
-            frequent_itemsets.push_back(single_item);
-            all_frequent.push_back({single_item, pair.second});
-        }
+            all_frequent.push_back({{item_ids[pair.first]}, pair.second});
     }
-    sort(frequent_itemsets.begin(), frequent_itemsets.end());
 
     cout << "Frequent 1-itemsets: " << frequent_itemsets.size() << endl;
 
-    // Find larger itemsets
-    for (int k = 2; !frequent_itemsets.empty(); ++k)
+    vector<pair<double, double>> intervals;
+    if (top_k > 0)
     {
-        vector<vector<string>> candidates = generate_candidates(frequent_itemsets);
-        if (candidates.empty())
-            break;
-
-        unordered_map<string, int> candidate_counts;
-        for (const auto &candidate : candidates)
-        {
-            candidate_counts[create_itemset_key(candidate)] = 0;
-        }
-
-        for (const auto &transaction : transactions)
-        {
-            for (const auto &candidate : candidates)
-            {
-                if (contains_itemset(transaction, candidate))
-                {
-                    candidate_counts[create_itemset_key(candidate)]++;
-                }
-            }
-        }
-
-        vector<vector<string>> new_frequent;
-        for (const auto &candidate : candidates)
+        Transactions transactions = read_transactions(input_file, threads, item_ids);
+        all_frequent.clear();
+        min_support_count = mine_top_k(transactions, frequent_itemsets, top_k, min_support_count, threads, all_frequent);
+        if (all_frequent.size() > top_k)
         {
-            string key = create_itemset_key(candidate);
-            if (candidate_counts[key] >= min_support_count)
+            vector<size_t> order(all_frequent.size());
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+            stable_sort(order.begin(), order.end(),
+                        [&](size_t a, size_t b) { return all_frequent[a].second > all_frequent[b].second; });
+            vector<bool> keep(all_frequent.size(), false);
+            for (size_t i = 0; i < top_k; ++i)
+                keep[order[i]] = true;
+            size_t kept = 0;
+            for (size_t i = 0; i < all_frequent.size(); ++i)
             {
-                new_frequent.push_back(candidate);
-                all_frequent.push_back({candidate, candidate_counts[key]});
+                if (keep[i] && kept != i)
+                    all_frequent[kept] = move(all_frequent[i]);
+                kept += keep[i];
             }
+            all_frequent.resize(kept);
         }
-
-        if (new_frequent.empty())
-            break;
-        cout << "Frequent " << k << "-itemsets: " << new_frequent.size() << endl;
-        frequent_itemsets = new_frequent;
+        cout << "Top-" << top_k << " threshold: " << min_support_count << " transactions ("
+             << 100.0 * min_support_count / num_transactions << "%), " << all_frequent.size() << " itemsets" << endl;
+    }
+    else if (mem_budget_mb > 0)
+    {
+        mine_partitioned(algo, input_file, item_ids, min_support_percent, min_support_count,
+                         (size_t)(mem_budget_mb * 1024 * 1024), threads, all_frequent);
     }
+    else
+    {
+        Transactions transactions = read_transactions(input_file, threads, item_ids);
+        mine_frequent(algo, transactions, frequent_itemsets, item_names.size(), min_support_count, threads, all_frequent,
+                      cout);
+    }
+
+    if (closed || maximal)
+        condense_results(all_frequent, intervals, maximal);
 
-    write_results(all_frequent, num_transactions, input_file);
+    write_results(all_frequent, item_names, num_transactions, input_file, intervals);
 
     return 0;
 }
\ No newline at end of file
@@ -4,8 +4,13 @@
 #include <set>
 #include <sstream>
 #include <algorithm>
-#include <iterator>
-#include <map>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include "../common/csv_loader.h"
+#include "../common/cli_flags.h"
+#include "../common/itemsets.h"
+#include "../common/tidset.h"
 using namespace std;
 
 using Transaction = vector<string>;
@@ -22,38 +27,20 @@ string trim(const string &s)
 
 vector<Transaction> read_transactions(const string &filename)
 {
-  ifstream fin(filename);
+  CSVTable table;
   vector<Transaction> transactions;
-  string line;
-
-  if (getline(fin, line))
-  {
-  }
+  if (!table.load(filename))
+    return transactions;
 
-  while (getline(fin, line))
+  for (size_t r = 0; r < table.rows(); r++)
   {
-    if (line.empty())
-      continue;
-    Transaction t;
-    stringstream ss(line);
-    string cell;
-
     vector<string> item_names;
-    int col_index = 0;
-    while (getline(ss, cell, ','))
+    for (size_t col_index = 1; col_index < table.width(r); col_index++)
     {
-      if (col_index == 0)
-      {
-        col_index++;
-        continue;
-      }
-
-      string trimmed = trim(cell);
-      if (trimmed == "1")
+      if (trimView(table.cell(r, col_index)) == "1")
       {
         item_names.push_back("Item" + to_string(col_index));
       }
-      col_index++;
     }
 
     if (!item_names.empty())
@@ -62,56 +49,33 @@ vector<Transaction> read_transactions(const string &filename)
       transactions.push_back(item_names);
     }
   }
-  fin.close();
   return transactions;
 }
 
-vector<Transaction> read_binary_transactions(const string &filename)
+vector<Transaction> read_binary_transactions(const string &filename, bool id_column)
 {
-  ifstream fin(filename);
+  CSVTable table;
   vector<Transaction> transactions;
-  string line;
 
-  if (!fin.is_open())
+  if (!table.load(filename))
   {
     cerr << "Error: Cannot open file " << filename << endl;
     return transactions;
   }
 
-  vector<string> item_names;
-  if (getline(fin, line))
-  {
-    stringstream header_ss(line);
-    string header_item;
+  size_t first_item = id_column ? 1 : 0;
+  vector<string> item_names = table.headerNames(true);
+  item_names.erase(item_names.begin(), item_names.begin() + min(first_item, item_names.size()));
 
-    getline(header_ss, header_item, ',');
-
-    while (getline(header_ss, header_item, ','))
-    {
-      item_names.push_back(trim(header_item));
-    }
-  }
-
-  while (getline(fin, line))
+  for (size_t r = 0; r < table.rows(); r++)
   {
-    if (line.empty())
-      continue;
-
     Transaction transaction_items;
-    stringstream ss(line);
-    string cell;
-
-    getline(ss, cell, ',');
-
-    int item_index = 0;
-    while (getline(ss, cell, ','))
+    for (size_t item_index = 0; item_index + first_item < table.width(r); item_index++)
     {
-      string trimmed_cell = trim(cell);
-      if (trimmed_cell == "1" && item_index < item_names.size())
+      if (trimView(table.cell(r, item_index + first_item)) == "1" && item_index < item_names.size())
       {
         transaction_items.push_back(item_names[item_index]);
       }
-      item_index++;
     }
 
     if (!transaction_items.empty())
@@ -121,52 +85,83 @@ vector<Transaction> read_binary_transactions(const string &filename)
     }
   }
 
-  fin.close();
   cout << "Read " << transactions.size() << " transactions with " << item_names.size() << " items" << endl;
+  table.printLoadStats();
   return transactions;
 }
 
-int count_support(const vector<Transaction> &transactions, const Itemset &itemset)
+class SupportIndex
 {
-  int count = 0;
-  for (const auto &t : transactions)
+public:
+  int find(const vector<uint32_t> &itemset) const
+  {
+    if (itemset.size() >= levels.size())
+      return -1;
+    uint32_t id = levels[itemset.size()].find(itemset);
+    return id == ItemsetIndex::npos ? -1 : counts[itemset.size()][id];
+  }
+
+  void add(const vector<uint32_t> &itemset, int count)
   {
-    bool present = true;
-    for (const auto &item : itemset)
+    while (levels.size() <= itemset.size())
     {
-      if (find(t.begin(), t.end(), item) == t.end())
-      {
-        present = false;
-        break;
-      }
+      levels.emplace_back(levels.size());
+      counts.emplace_back();
     }
-    if (present)
-      count++;
+    if (levels[itemset.size()].insert(itemset) == counts[itemset.size()].size())
+      counts[itemset.size()].push_back(count);
   }
-  return count;
-}
 
-vector<Itemset> generate_subsets(const Itemset &items)
+private:
+  vector<ItemsetIndex> levels;
+  vector<vector<int>> counts;
+};
+
+TidSets build_tidsets(const vector<Transaction> &transactions, const vector<string> &item_names)
 {
-  vector<string> elems(items.begin(), items.end());
-  vector<Itemset> subsets;
-  int n = elems.size();
-  for (int mask = 1; mask < (1 << n) - 1; ++mask)
+  TidSets tidsets(transactions.size());
+  for (size_t i = 0; i < item_names.size(); i++)
+    tidsets.add();
+  for (size_t t = 0; t < transactions.size(); t++)
   {
-    Itemset s;
-    for (int i = 0; i < n; ++i)
-    {
-      if (mask & (1 << i))
-        s.insert(elems[i]);
-    }
-    if (!s.empty() && s.size() < items.size())
-    {
-      subsets.push_back(s);
-    }
+    for (const auto &item : transactions[t])
+      tidsets.set(lower_bound(item_names.begin(), item_names.end(), item) - item_names.begin(), t);
   }
-  return subsets;
+  return tidsets;
 }
 
+class SupportCounter
+{
+public:
+  SupportCounter(const SupportIndex &listed, const TidSets &tidsets) : listed(listed), tidsets(tidsets) {}
+
+  int support(const vector<uint32_t> &itemset)
+  {
+    int count = listed.find(itemset);
+    if (count < 0)
+      count = counted.find(itemset);
+    if (count >= 0)
+      return count;
+    const uint64_t *first = tidsets[itemset[0]];
+    scratch.assign(first, first + tidsets.words());
+    count = (int)andCount(scratch.data(), scratch.data(), scratch.data(), tidsets.words());
+    for (size_t i = 1; i < itemset.size(); i++)
+      count = (int)andCount(scratch.data(), tidsets[itemset[i]], scratch.data(), tidsets.words());
+    counted.add(itemset, count);
+    misses++;
+    return count;
+  }
+
+  size_t computed() const { return misses; }
+
+private:
+  const SupportIndex &listed;
+  const TidSets &tidsets;
+  SupportIndex counted;
+  vector<uint64_t> scratch;
+  size_t misses = 0;
+};
+
 Itemset parse_itemset(const string &itemset_str)
 {
   Itemset result;
@@ -188,81 +183,206 @@ Itemset parse_itemset(const string &itemset_str)
   return result;
 }
 
+int itemset_rules(const vector<uint32_t> &itemset, int itemset_count, SupportCounter &counter,
+                  const vector<string> &item_names, double min_confidence, int total_tx, string &out)
+{
+  if (itemset_count < 0)
+    itemset_count = counter.support(itemset);
+  int n = itemset.size();
+  int full = (1 << n) - 1;
+  vector<int> consequents, next;
+  vector<pair<int, double>> rules;
+  vector<uint32_t> antecedent;
+  for (int j = 0; j < n; j++)
+    consequents.push_back(1 << j);
+
+  for (int size = 1; size < n && !consequents.empty(); size++)
+  {
+    vector<int> kept;
+    for (int consequent : consequents)
+    {
+      antecedent.clear();
+      for (int j = 0; j < n; j++)
+      {
+        if (!(consequent & (1 << j)))
+          antecedent.push_back(itemset[j]);
+      }
+      int subset_count = counter.support(antecedent);
+      double confidence = subset_count ? (double)itemset_count / subset_count * 100.0 : 0.0;
+      if (subset_count && confidence < min_confidence)
+        continue;
+      kept.push_back(consequent);
+      if (subset_count && confidence <= 100.0)
+        rules.push_back({full ^ consequent, confidence});
+    }
+
+    next.clear();
+    for (int consequent : kept)
+    {
+      for (int j = 32 - __builtin_clz(consequent); j < n; j++)
+      {
+        int candidate = consequent | (1 << j);
+        bool valid = true;
+        for (int bit = candidate; bit && valid; bit &= bit - 1)
+          valid = binary_search(kept.begin(), kept.end(), candidate ^ (bit & -bit));
+        if (valid)
+          next.push_back(candidate);
+      }
+    }
+    sort(next.begin(), next.end());
+    consequents.swap(next);
+  }
+
+  sort(rules.begin(), rules.end());
+  double support = (double)itemset_count / total_tx * 100.0;
+  char numbers[64];
+  for (const auto &rule : rules)
+  {
+    for (int side = 1; side >= 0; side--)
+    {
+      out += '"';
+      bool first = true;
+      for (int j = 0; j < n; j++)
+      {
+        if (((rule.first >> j) & 1) == side)
+        {
+          if (!first)
+            out += ',';
+          out += item_names[itemset[j]];
+          first = false;
+        }
+      }
+      out += "\",";
+    }
+    snprintf(numbers, sizeof(numbers), "%g,%g\n", support, rule.second);
+    out += numbers;
+  }
+  return rules.size();
+}
+
 void generate_association_rules(const vector<Transaction> &transactions,
                                 const vector<pair<Itemset, int>> &frequent_itemsets,
                                 double min_confidence,
-                                const string &output_file)
+                                const string &output_file,
+                                int threads)
 {
   ofstream fout(output_file);
   fout << "Antecedent,Consequent,Support,Confidence\n";
   int total_tx = transactions.size();
   int rules_count = 0;
 
-  map<Itemset, int> support_map;
+  vector<string> item_names;
+  for (const auto &t : transactions)
+    item_names.insert(item_names.end(), t.begin(), t.end());
   for (const auto &p : frequent_itemsets)
-  {
-    support_map[p.first] = p.second;
-  }
+    item_names.insert(item_names.end(), p.first.begin(), p.first.end());
+  sort(item_names.begin(), item_names.end());
+  item_names.erase(unique(item_names.begin(), item_names.end()), item_names.end());
 
+  SupportIndex index;
+  vector<pair<vector<uint32_t>, int>> all_itemsets;
+  vector<vector<size_t>> by_size;
   for (const auto &p : frequent_itemsets)
   {
-    const Itemset &itemset = p.first;
-    int itemset_count = p.second;
-    if (itemset.size() < 2)
-      continue;
+    vector<uint32_t> itemset;
+    for (const auto &item : p.first)
+      itemset.push_back((uint32_t)(lower_bound(item_names.begin(), item_names.end(), item) - item_names.begin()));
+    index.add(itemset, p.second);
+    while (by_size.size() <= itemset.size())
+      by_size.emplace_back();
+    by_size[itemset.size()].push_back(all_itemsets.size());
+    all_itemsets.push_back({itemset, p.second});
+  }
 
-    vector<Itemset> subsets = generate_subsets(itemset);
-    for (const auto &subset : subsets)
+  vector<ItemsetIndex> missing;
+  for (size_t k = 0; k < by_size.size(); k++)
+    missing.emplace_back(k);
+  bool complete = true;
+  vector<uint32_t> subset;
+  auto expand = [&](const uint32_t *itemset, size_t k) {
+    for (size_t skip = 0; skip < k; skip++)
     {
-      Itemset remaining;
-      set_difference(itemset.begin(), itemset.end(),
-                     subset.begin(), subset.end(),
-                     inserter(remaining, remaining.begin()));
-
-      auto subset_it = support_map.find(subset);
-      if (subset_it == support_map.end())
-      {
-        continue; 
-      }
-      int subset_count = subset_it->second;
-
-      if (subset_count == 0)
+      subset.assign(itemset, itemset + skip);
+      subset.insert(subset.end(), itemset + skip + 1, itemset + k);
+      if (index.find(subset) >= 0)
         continue;
+      complete = false;
+      if (k > 2)
+        missing[k - 1].insert(subset);
+    }
+  };
+  for (size_t k = by_size.size(); k-- > 2;)
+  {
+    for (size_t i : by_size[k])
+      expand(all_itemsets[i].first.data(), k);
+    for (size_t m = 0; m < missing[k].size(); m++)
+      expand(missing[k][m], k);
+  }
+  size_t listed = all_itemsets.size();
+  for (size_t k = 2; k < missing.size(); k++)
+  {
+    for (size_t m = 0; m < missing[k].size(); m++)
+      all_itemsets.push_back({missing[k].itemset(m), -1});
+  }
+  TidSets tidsets;
+  if (!complete)
+  {
+    tidsets = build_tidsets(transactions, item_names);
+    cout << "Itemset file is condensed: " << all_itemsets.size() - listed
+         << " missing itemsets added, supports come from the bitset index" << endl;
+  }
 
-      double confidence = (double)itemset_count / subset_count * 100.0;
-      double support = (double)itemset_count / total_tx * 100.0;
-
-      if (confidence >= min_confidence && confidence <= 100.0)
+  const size_t block = 256;
+  size_t blocks = (all_itemsets.size() + block - 1) / block;
+  if (threads > (int)blocks)
+    threads = max(1, (int)blocks);
+  vector<string> buffers(blocks);
+  vector<int> counts(threads, 0);
+  vector<size_t> computed(threads, 0);
+  atomic<size_t> next_block{0};
+  auto generate = [&](int t) {
+    SupportCounter counter(index, tidsets);
+    for (size_t b = next_block++; b < blocks; b = next_block++)
+    {
+      for (size_t i = b * block; i < min(all_itemsets.size(), (b + 1) * block); i++)
       {
-        fout << "\"";
-        auto it = subset.begin();
-        fout << *it;
-        for (++it; it != subset.end(); ++it)
-          fout << "," << *it;
-        fout << "\",";
-
-        fout << "\"";
-        it = remaining.begin();
-        fout << *it;
-        for (++it; it != remaining.end(); ++it)
-          fout << "," << *it;
-        fout << "\",";
-
-        fout << support << "," << confidence << "\n";
-        rules_count++;
+        if (all_itemsets[i].first.size() >= 2)
+          counts[t] += itemset_rules(all_itemsets[i].first, all_itemsets[i].second, counter, item_names,
+                                     min_confidence, total_tx, buffers[b]);
       }
     }
+    computed[t] = counter.computed();
+  };
+  vector<thread> workers;
+  for (int t = 1; t < threads; t++)
+    workers.emplace_back(generate, t);
+  generate(0);
+  for (auto &w : workers)
+    w.join();
+  for (const auto &buffer : buffers)
+    fout << buffer;
+  size_t counted = 0;
+  for (int t = 0; t < threads; t++)
+  {
+    rules_count += counts[t];
+    counted += computed[t];
   }
+  if (counted > 0)
+    cout << "Counted " << counted << " supports with the bitset index" << endl;
   fout.close();
   cout << "Generated " << rules_count << " association rules -> " << output_file << endl;
 }
 
 int main(int argc, char **argv)
 {
-  if (argc < 4)
+  int threads = takeThreadsFlag(argc, argv);
+  bool id_column = !takeSwitch(argc, argv, "--no-id-column");
+  if (argc < 4 || threads < 1)
   {
-    cout << "Usage: " << argv[0] << " <transactions.csv> <frequent_itemsets.csv> <min_confidence%>" << endl;
+    cout << "Usage: " << argv[0] << " <transactions.csv> <frequent_itemsets.csv> <min_confidence%> [--threads N]"
+         << " [--no-id-column]" << endl;
     cout << "Example: " << argv[0] << " transactions.csv frequent_itemsets.csv 60" << endl;
+    cout << "The first column is a transaction ID unless --no-id-column is given" << endl;
     return 1;
   }
 
@@ -271,50 +391,27 @@ int main(int argc, char **argv)
   double min_confidence = stod(argv[3]);
 
   cout << "Reading transactions..." << endl;
-  vector<Transaction> transactions = read_binary_transactions(tx_file);
+  vector<Transaction> transactions = read_binary_transactions(tx_file, id_column);
   cout << "Read " << transactions.size() << " transactions" << endl;
 
   vector<pair<Itemset, int>> frequent_itemsets;
-  ifstream fin(freq_file);
-  if (!fin.is_open())
+  CSVTable freq_table;
+  if (!freq_table.load(freq_file))
   {
     cerr << "Error: Cannot open frequent itemsets file " << freq_file << endl;
     return 1;
   }
 
-  string line;
-  getline(fin, line);
-
-  while (getline(fin, line))
+  for (size_t r = 0; r < freq_table.rows(); r++)
   {
-    if (line.empty())
-      continue;
-
-    string itemset_str, count_str, support_str;
-    stringstream ss(line);
-
-    if (line[0] == '"')
+    if (freq_table.width(r) < 2)
     {
-      size_t end_quote = line.find('"', 1);
-      if (end_quote == string::npos)
-      {
-        cerr << "Warning: Malformed line (missing closing quote): " << line << endl;
-        continue;
-      }
-      itemset_str = line.substr(0, end_quote + 1);
-      string rest = line.substr(end_quote + 2);
-      stringstream rest_ss(rest);
-      getline(rest_ss, count_str, ',');
-      getline(rest_ss, support_str, ',');
-    }
-    else
-    {
-      getline(ss, itemset_str, ',');
-      getline(ss, count_str, ',');
-      getline(ss, support_str, ',');
+      cerr << "Warning: Malformed row " << r + 1 << " in " << freq_file << endl;
+      continue;
     }
 
-    count_str = trim(count_str);
+    string itemset_str = freq_table.cellText(r, 0);
+    string count_str(trimView(freq_table.cell(r, 1)));
 
     try
     {
@@ -324,11 +421,11 @@ int main(int argc, char **argv)
     }
     catch (const std::invalid_argument &e)
     {
-      cerr << "Error: Cannot convert count '" << count_str << "' to integer in line: " << line << endl;
+      cerr << "Error: Cannot convert count '" << count_str << "' to integer in row " << r + 1 << endl;
       continue;
     }
   }
-  fin.close();
+  freq_table.printLoadStats();
 
   cout << "Successfully read " << frequent_itemsets.size() << " frequent itemsets" << endl;
 
@@ -338,7 +435,7 @@ int main(int argc, char **argv)
     return 1;
   }
 
-  generate_association_rules(transactions, frequent_itemsets, min_confidence, "association_rules.csv");
+  generate_association_rules(transactions, frequent_itemsets, min_confidence, "association_rules.csv", threads);
 
   return 0;
 }
\ No newline at end of file
@@ -6,40 +6,35 @@
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
+#include "../common/column_cache.h"
+#include "../common/cli_flags.h"
 using namespace std;
 
-vector<string> split(const string &line)
+struct CorrelationSums
 {
-    vector<string> result;
-    stringstream ss(line);
-    string item;
-    while (getline(ss, item, ','))
-    {
-        result.push_back(item);
-    }
-    return result;
-}
-
-double calculateCorrelation(const vector<double> &x, const vector<double> &y)
-{
-    int n = x.size();
-    if (n <= 1)
-        return 0.0;
-
+    long long n = 0;
     double sum_x = 0.0, sum_y = 0.0;
     double sum_xy = 0.0, sum_x2 = 0.0, sum_y2 = 0.0;
 
-    for (int i = 0; i < n; ++i)
+    void add(double x, double y)
     {
-        sum_x += x[i];
-        sum_y += y[i];
-        sum_xy += x[i] * y[i];
-        sum_x2 += x[i] * x[i];
-        sum_y2 += y[i] * y[i];
+        n++;
+        sum_x += x;
+        sum_y += y;
+        sum_xy += x * y;
+        sum_x2 += x * x;
+        sum_y2 += y * y;
     }
+};
+
+double calculateCorrelation(const CorrelationSums &s)
+{
+    if (s.n <= 1)
+        return 0.0;
 
-    double numerator = n * sum_xy - sum_x * sum_y;
-    double denominator = sqrt((n * sum_x2 - sum_x * sum_x) * (n * sum_y2 - sum_y * sum_y));
+    double n = (double)s.n;
+    double numerator = n * s.sum_xy - s.sum_x * s.sum_y;
+    double denominator = sqrt((n * s.sum_x2 - s.sum_x * s.sum_x) * (n * s.sum_y2 - s.sum_y * s.sum_y));
 
     if (denominator == 0.0)
         return 0.0;
@@ -48,53 +43,32 @@ double calculateCorrelation(const vector<double> &x, const vector<double> &y)
 
 int main(int argc, char *argv[])
 {
+    string na;
+    if (takeFlag(argc, argv, "--na", na))
+        naTokens().set(na);
     if (argc < 2)
     {
-        cerr << "Usage: " << argv[0] << " <input_csv_file>" << endl;
+        cerr << "Usage: " << argv[0] << " <input_csv_file> [--na TOKEN,TOKEN...]" << endl;
         return 1;
     }
 
     string inputFilename = argv[1];
-    ifstream fin(inputFilename);
-    if (!fin)
+    ColumnCache table;
+    if (!table.open(inputFilename))
     {
         cerr << "Error opening input file" << endl;
         return 1;
     }
 
-    string line;
-    vector<string> headers;
-    vector<vector<double>> columns;
-
-    // Read header
-    if (getline(fin, line))
-    {
-        headers = split(line);
-        columns.resize(headers.size());
-    }
-
-    // Read data
-    while (getline(fin, line))
-    {
-        auto row = split(line);
-        for (size_t i = 0; i < row.size(); i++)
-        {
-            try
-            {
-                columns[i].push_back(stod(row[i]));
-            }
-            catch (...)
-            {
-                cerr << "Warning: Invalid number in column " << headers[i] << endl;
-            }
-        }
-    }
-    fin.close();
+    vector<string> headers = table.headerNames();
+    vector<ColumnParseStats> stats = table.stats();
+    table.printLoadStats();
+    printParseStats(headers, stats);
 
     cout << "Available columns:\n";
     for (size_t i = 0; i < headers.size(); i++)
     {
-        cout << i << ": " << headers[i] << " (" << columns[i].size() << " values)\n";
+        cout << i << ": " << headers[i] << " (" << stats[i].valid << " values)\n";
     }
 
     // Ask user which columns to correlate
@@ -110,14 +84,21 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    if (columns[col1].size() != columns[col2].size())
+    if (stats[col1].valid != stats[col2].valid)
     {
         cerr << "Column sizes don't match!" << endl;
         return 1;
     }
 
     // Calculate correlation
-    double correlation = calculateCorrelation(columns[col1], columns[col2]);
+    CorrelationSums sums;
+    for (size_t r = 0; r < table.rows(); r++)
+    {
+        double x, y;
+        if (table.number(r, col1, x) == ParseStatus::Ok && table.number(r, col2, y) == ParseStatus::Ok)
+            sums.add(x, y);
+    }
+    double correlation = calculateCorrelation(sums);
 
     // Determine correlation type
     string type;
@@ -7,6 +7,9 @@
 #include <cstdlib>
 #include <ctime>
 #include <unordered_set>
+#include "../common/column_cache.h"
+#include "../common/cli_flags.h"
+#include "../common/csv_writer.h"
 
 using namespace std;
 
@@ -26,37 +29,21 @@ double distance(const vector<double> &a, const vector<double> &b)
     return sqrt(sum);
 }
 
-vector<Point> readCSV(const string &filename, const vector<int> &columns)
+vector<Point> loadPoints(const ColumnCache &table, const vector<int> &columns)
 {
     vector<Point> points;
-    ifstream file(filename);
 
-    if (!file.is_open())
+    for (size_t r = 0; r < table.rows(); r++)
     {
-        cerr << "Error: Cannot open file " << filename << endl;
-        return points;
-    }
-
-    string line;
-    getline(file, line);
-
-    while (getline(file, line))
-    {
-        stringstream ss(line);
-        string value;
-        vector<string> row;
-
-        while (getline(ss, value, ','))
-        {
-            row.push_back(value);
-        }
-
         Point p;
         for (int col : columns)
         {
-            if (col - 1 < (int)row.size())
+            if (col >= 1 && col <= (int)table.columns() && table.present(r, col - 1))
             {
-                p.values.push_back(stod(row[col - 1]));
+                double value;
+                if (table.number(r, col - 1, value) != ParseStatus::Ok)
+                    value = 0.0;
+                p.values.push_back(value);
             }
         }
 
@@ -66,7 +53,6 @@ vector<Point> readCSV(const string &filename, const vector<int> &columns)
         }
     }
 
-    file.close();
     return points;
 }
 
@@ -155,32 +141,23 @@ vector<vector<double>> updateCentroids(const vector<Point> &points, int k)
 
 int main(int argc, char *argv[])
 {
-    if (argc != 2)
+    int threads = takeThreadsFlag(argc, argv);
+    if (argc != 2 || threads < 1)
     {
-        cerr << "Usage: " << argv[0] << " <input.csv>" << endl;
+        cerr << "Usage: " << argv[0] << " <input.csv> [--threads N]" << endl;
         return 1;
     }
 
     string filename = argv[1];
-    ifstream test(filename);
-    if (!test.is_open())
+    ColumnCache table;
+    if (!table.open(filename, threads))
     {
         cerr << "Error: Cannot open CSV file " << filename << endl;
         return 1;
     }
+    table.printLoadStats();
 
-    string headerLine;
-    getline(test, headerLine);
-    test.close();
-
-    stringstream ss(headerLine);
-    string col;
-    vector<string> columns;
-
-    while (getline(ss, col, ','))
-    {
-        columns.push_back(col);
-    }
+    vector<string> columns = table.headerNames();
 
     cout << "Available columns:" << endl;
     for (size_t i = 0; i < columns.size(); i++)
@@ -201,7 +178,7 @@ int main(int argc, char *argv[])
         selected.push_back(colNum);
     }
 
-    vector<Point> points = readCSV(filename, selected);
+    vector<Point> points = loadPoints(table, selected);
 
     if (points.empty())
     {
@@ -232,23 +209,25 @@ int main(int argc, char *argv[])
         iterations++;
     } while (changed && iterations < maxIter);
 
-    ofstream out("output.csv");
-    out << "Cluster";
+    CSVWriter out;
+    out.open("output.csv");
+    out.cell("Cluster");
     for (size_t i = 0; i < points[0].values.size(); i++)
     {
-        out << ",Value" << (i + 1);
+        out.cell("Value");
+        out.text(i + 1);
     }
-    out << "\n";
+    out.endRow();
 
-    for (const auto &p : points)
+    out.writeRows(points.size(), threads, [&](CSVFormatter &row, size_t r)
     {
-        out << p.cluster;
-        for (double val : p.values)
+        row.cell(points[r].cluster);
+        for (double val : points[r].values)
         {
-            out << "," << val;
+            row.cell(val);
         }
-        out << "\n";
-    }
+        row.endRow();
+    });
     out.close();
 
     cout << "Clustering completed in " << iterations << " iterations" << endl;
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <cstdio>
+#include "../common/column_cache.h"
+using namespace std;
+
+string writeWideCSV(size_t rows, size_t columns)
+{
+  string filename = "wide_" + to_string(rows) + "x" + to_string(columns) + ".csv";
+  ofstream out(filename);
+  for (size_t c = 0; c < columns; c++)
+    out << (c ? "," : "") << "col" << c;
+  out << "\n";
+  unsigned long long seed = 7;
+  for (size_t r = 0; r < rows; r++)
+  {
+    for (size_t c = 0; c < columns; c++)
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      out << (c ? "," : "") << (seed >> 40) % 100000 / 100.0;
+    }
+    out << "\n";
+  }
+  return filename;
+}
+
+double sumFromCSV(const string &filename, const vector<size_t> &selected)
+{
+  CSVTable table;
+  table.load(filename);
+  double sum = 0;
+  for (size_t r = 0; r < table.rows(); r++)
+    for (size_t c : selected)
+    {
+      double value;
+      if (c < table.width(r) && parseNumber(table.cell(r, c), value) == ParseStatus::Ok)
+        sum += value;
+    }
+  return sum;
+}
+
+double sumFromCache(const string &filename, const vector<size_t> &selected)
+{
+  ColumnCache table;
+  table.open(filename);
+  double sum = 0;
+  for (size_t c : selected)
+    for (double value : table.numbers(c))
+      sum += value;
+  return sum;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t rows = argc > 1 ? stoul(argv[1]) : 50000;
+  size_t columns = argc > 2 ? stoul(argv[2]) : 200;
+  vector<size_t> selected = {3, columns / 2};
+
+  cout << "Generating " << rows << " x " << columns << " synthetic table..." << endl;
+  string filename = writeWideCSV(rows, columns);
+  string cachePath = filename + ".dmcol";
+  remove(cachePath.c_str());
+
+  vector<pair<string, function<double()>>> methods = {
+      {"CSV parse", [&]() { return sumFromCSV(filename, selected); }},
+      {"cache build", [&]() { remove(cachePath.c_str()); return sumFromCache(filename, selected); }},
+      {"cache reuse", [&]() { return sumFromCache(filename, selected); }}};
+
+  ofstream fout("column_cache_benchmark.csv");
+  fout << "method,rows,columns,selected,best_ms\n";
+  cout << "\n" << left << setw(16) << "Method" << right << setw(12) << "ms" << setw(16) << "checksum" << endl;
+  for (auto &method : methods)
+  {
+    double best = 1e30, checksum = 0;
+    for (int run = 0; run < 3; run++)
+    {
+      auto start = chrono::steady_clock::now();
+      checksum = method.second();
+      best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    cout << left << setw(16) << method.first << right << setw(12) << fixed << setprecision(1) << best * 1000.0
+         << setw(16) << setprecision(0) << checksum << endl;
+    fout << method.first << "," << rows << "," << columns << "," << selected.size() << "," << best * 1000.0 << "\n";
+  }
+  fout.close();
+
+  cout << "\nResults saved to column_cache_benchmark.csv" << endl;
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "../common/csv_loader.h"
+#include "../common/csv_writer.h"
+using namespace std;
+
+int main()
+{
+  vector<vector<string>> rows = {{"name", "city", "note"},
+                                 {"A", "Pune, MH", "12\" pizza"},
+                                 {"B", "said \"hi\", then left", ""},
+                                 {"C", "two\nlines", "cr\rhere"},
+                                 {"D", "plain", "\"\""}};
+  string filename = "synthetic_roundtrip.csv";
+  CSVWriter out;
+  if (!out.open(filename))
+  {
+    cerr << "Error: Cannot create file " << filename << endl;
+    return 1;
+  }
+  for (const auto &row : rows)
+  {
+    for (const auto &value : row)
+      out.cell(value);
+    out.endRow();
+  }
+  out.close();
+
+  CSVTable table;
+  if (!table.load(filename))
+  {
+    cerr << "Error: Cannot open file " << filename << endl;
+    return 1;
+  }
+
+  int failures = 0;
+  if (table.headerNames() != rows[0])
+    failures++;
+  if (table.rows() != rows.size() - 1)
+    failures++;
+  for (size_t r = 0; r < table.rows() && r + 1 < rows.size(); r++)
+  {
+    bool ok = table.rowText(r) == rows[r + 1];
+    cout << "Row " << r + 1 << ": " << (ok ? "ok" : "MISMATCH") << endl;
+    failures += !ok;
+  }
+  remove(filename.c_str());
+  cout << (failures ? "FAILED" : "PASSED") << endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include "../common/csv_loader.h"
+#include "synthetic_data.h"
+using namespace std;
+
+size_t countGetlineStringstream(const string &filename)
+{
+  ifstream file(filename);
+  string line;
+  size_t cells = 0;
+  while (getline(file, line))
+  {
+    stringstream ss(line);
+    string cell;
+    while (getline(ss, cell, ','))
+      cells++;
+  }
+  return cells;
+}
+
+size_t countCharLoop(const string &filename)
+{
+  ifstream file(filename);
+  string line;
+  size_t cells = 0;
+  while (getline(file, line))
+  {
+    vector<string> fields;
+    bool inQuotes = false;
+    string currentField;
+    for (size_t i = 0; i < line.length(); i++)
+    {
+      char c = line[i];
+      if (c == '"')
+        inQuotes = !inQuotes;
+      else if (c == ',' && !inQuotes)
+      {
+        fields.push_back(currentField);
+        currentField.clear();
+      }
+      else
+        currentField += c;
+    }
+    fields.push_back(currentField);
+    cells += fields.size();
+  }
+  return cells;
+}
+
+size_t countTokenizer(const string &filename, ScanLevel level)
+{
+  CSVTable table;
+  table.load(filename, 1, level);
+  size_t cells = table.columns();
+  for (size_t r = 0; r < table.rows(); r++)
+    cells += table.width(r);
+  return cells;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t rows = argc > 1 ? stoul(argv[1]) : 1000000;
+
+  cout << "Generating " << rows << " synthetic rows..." << endl;
+  string filename = writeSyntheticCSV(rows);
+  ifstream probe(filename, ios::binary | ios::ate);
+  double mb = probe.tellg() / (1024.0 * 1024.0);
+  probe.close();
+  cout << "Input: " << filename << " (" << fixed << setprecision(1) << mb << " MB)" << endl;
+
+  vector<pair<string, function<size_t()>>> methods = {
+      {"getline+stringstream", [&]() { return countGetlineStringstream(filename); }},
+      {"char loop (dice.cpp)", [&]() { return countCharLoop(filename); }},
+      {"tokenizer scalar", [&]() { return countTokenizer(filename, ScanLevel::Scalar); }}};
+  if (bestScanLevel() != ScanLevel::Scalar)
+    methods.push_back({"tokenizer SSE2", [&]() { return countTokenizer(filename, ScanLevel::SSE2); }});
+  if (bestScanLevel() == ScanLevel::AVX2)
+    methods.push_back({"tokenizer AVX2", [&]() { return countTokenizer(filename, ScanLevel::AVX2); }});
+
+  ofstream fout("tokenizer_benchmark.csv");
+  fout << "method,cells,best_ms,mb_per_s\n";
+  cout << "\n" << left << setw(24) << "Method" << right << setw(12) << "Cells" << setw(12) << "ms" << setw(12) << "MB/s" << endl;
+  for (auto &method : methods)
+  {
+    double best = 1e30;
+    size_t cells = 0;
+    for (int run = 0; run < 3; run++)
+    {
+      auto start = chrono::steady_clock::now();
+      cells = method.second();
+      best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    cout << left << setw(24) << method.first << right << setw(12) << cells << setw(12) << setprecision(1)
+         << best * 1000.0 << setw(12) << mb / best << endl;
+    fout << method.first << "," << cells << "," << best * 1000.0 << "," << mb / best << "\n";
+  }
+  fout.close();
+
+  cout << "\nRuntime dispatch selects: " << scanLevelName(bestScanLevel()) << endl;
+  cout << "Results saved to tokenizer_benchmark.csv" << endl;
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <thread>
+#include <cstdio>
+#include "../common/csv_writer.h"
+#include "../common/cli_flags.h"
+using namespace std;
+
+struct Assignment
+{
+  int cluster;
+  double values[4];
+};
+
+vector<Assignment> makeAssignments(size_t rows)
+{
+  vector<Assignment> points(rows);
+  unsigned long long seed = 11;
+  for (auto &p : points)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    p.cluster = (int)((seed >> 33) % 8);
+    for (double &v : p.values)
+    {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      v = (seed >> 20) % 10000000 / 1000.0;
+    }
+  }
+  return points;
+}
+
+void writeOfstream(const string &filename, const vector<Assignment> &points, bool flushEveryRow)
+{
+  ofstream out(filename);
+  out << "Cluster,Value1,Value2,Value3,Value4\n";
+  for (const auto &p : points)
+  {
+    out << p.cluster;
+    for (double v : p.values)
+      out << "," << v;
+    if (flushEveryRow)
+      out << endl;
+    else
+      out << "\n";
+  }
+}
+
+void writeCSVWriter(const string &filename, const vector<Assignment> &points, int threads)
+{
+  CSVWriter out;
+  out.open(filename);
+  out.text("Cluster,Value1,Value2,Value3,Value4\n");
+  out.writeRows(points.size(), threads, [&](CSVFormatter &row, size_t r) {
+    row.cell(points[r].cluster);
+    for (double v : points[r].values)
+      row.cell(v);
+    row.endRow();
+  });
+  out.close();
+}
+
+size_t fileSize(const string &filename)
+{
+  ifstream in(filename, ios::binary | ios::ate);
+  return in ? (size_t)in.tellg() : 0;
+}
+
+int main(int argc, char *argv[])
+{
+  string value;
+  int maxThreads = takeFlag(argc, argv, "--threads", value) ? atoi(value.c_str()) : (int)thread::hardware_concurrency();
+  if (maxThreads < 1)
+    maxThreads = 1;
+  size_t rows = argc > 1 ? stoul(argv[1]) : 1000000;
+
+  cout << "Generating " << rows << " synthetic assignments..." << endl;
+  vector<Assignment> points = makeAssignments(rows);
+  string filename = "synthetic_writer_output.csv";
+
+  vector<pair<string, function<void()>>> methods = {
+      {"ofstream + endl", [&]() { writeOfstream(filename, points, true); }},
+      {"ofstream + \\n", [&]() { writeOfstream(filename, points, false); }},
+      {"CSVWriter", [&]() { writeCSVWriter(filename, points, 1); }}};
+  if (maxThreads > 1)
+    methods.push_back({"CSVWriter x" + to_string(maxThreads), [&]() { writeCSVWriter(filename, points, maxThreads); }});
+
+  ofstream fout("csv_writer_benchmark.csv");
+  fout << "method,rows,best_ms,mb_per_s\n";
+  cout << "\n" << left << setw(20) << "Method" << right << setw(12) << "ms" << setw(12) << "MB/s" << setw(14) << "bytes" << endl;
+  for (auto &method : methods)
+  {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++)
+    {
+      auto start = chrono::steady_clock::now();
+      method.second();
+      best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    size_t bytes = fileSize(filename);
+    double mb = bytes / (1024.0 * 1024.0);
+    cout << left << setw(20) << method.first << right << setw(12) << fixed << setprecision(1) << best * 1000.0
+         << setw(12) << mb / best << setw(14) << bytes << endl;
+    fout << method.first << "," << rows << "," << best * 1000.0 << "," << mb / best << "\n";
+  }
+  fout.close();
+  remove(filename.c_str());
+
+  cout << "\nResults saved to csv_writer_benchmark.csv" << endl;
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "../common/cli_flags.h"
+using namespace std;
+
+string writeBaskets(size_t rows, size_t items)
+{
+  string filename = "synthetic_baskets_" + to_string(rows) + ".csv";
+  ofstream out(filename, ios::binary);
+  for (size_t i = 0; i < items; i++)
+    out << (i ? "," : "") << "item" << i;
+  out << "\n";
+  unsigned long long seed = 29;
+  auto next = [&]() {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return seed >> 33;
+  };
+  vector<char> row(items);
+  for (size_t r = 0; r < rows; r++)
+  {
+    fill(row.begin(), row.end(), '0');
+    size_t size = 2 + next() % 10;
+    for (size_t i = 0; i < size; i++)
+      row[(next() % items) * (next() % items) / items] = '1';
+    size_t bundle = next() % 8;
+    if (bundle < 3)
+      for (size_t i = 0; i < 4 + bundle; i++)
+        row[bundle * 7 + i] = '1';
+    for (size_t i = 0; i < items; i++)
+      out << (i ? "," : "") << row[i];
+    out << "\n";
+  }
+  return filename;
+}
+
+string readFile(const string &filename)
+{
+  ifstream in(filename, ios::binary);
+  stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+int main(int argc, char *argv[])
+{
+  string value;
+  double budget = takeFlag(argc, argv, "--budget", value) ? atof(value.c_str()) : 30.0;
+  if (argc < 2)
+  {
+    cout << "Usage: " << argv[0] << " <apriori_binary> [rows] [items] [--budget seconds]" << endl;
+    return 1;
+  }
+  string binary = argv[1];
+  size_t rows = argc > 2 ? stoul(argv[2]) : 50000;
+  size_t items = argc > 3 ? stoul(argv[3]) : 80;
+
+  cout << "Generating " << rows << " synthetic baskets over " << items << " items..." << endl;
+  string input = writeBaskets(rows, items);
+  string output = input.substr(0, input.size() - 4) + "_frequent_itemsets.csv";
+#ifdef _WIN32
+  string quiet = " > NUL";
+#else
+  string quiet = " > /dev/null";
+#endif
+
+  vector<string> algorithms = {"apriori", "vertical", "fpgrowth", "eclat"};
+  vector<double> supports = {10, 5, 2, 1, 0.5, 0.25};
+  vector<bool> skipped(algorithms.size(), false);
+
+  ofstream fout("frequent_itemsets_benchmark.csv");
+  fout << "support_percent,algorithm,itemsets,ms\n";
+  cout << "\n" << setw(10) << "support%" << setw(12) << "itemsets";
+  for (const auto &algorithm : algorithms)
+    cout << setw(14) << algorithm + " ms";
+  cout << endl;
+
+  for (double support : supports)
+  {
+    string reference;
+    size_t itemsets = 0;
+    vector<string> cells;
+    for (size_t a = 0; a < algorithms.size(); a++)
+    {
+      if (skipped[a])
+      {
+        cells.push_back("skipped");
+        continue;
+      }
+      ostringstream command;
+      command << "\"" << binary << "\" ./" << input << " " << support << " --algo " << algorithms[a] << quiet;
+      remove(output.c_str());
+      auto start = chrono::steady_clock::now();
+      int rc = system(command.str().c_str());
+      double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      if (rc != 0)
+      {
+        cerr << "Error: " << algorithms[a] << " failed at " << support << "%" << endl;
+        return 1;
+      }
+
+      string result = readFile(output);
+      if (reference.empty())
+      {
+        reference = result;
+        for (char c : result)
+          itemsets += c == '\n';
+        itemsets = itemsets ? itemsets - 1 : 0;
+      }
+      else if (result != reference)
+      {
+        cerr << "Error: " << algorithms[a] << " output differs at " << support << "%" << endl;
+        return 1;
+      }
+
+      ostringstream ms;
+      ms << fixed << setprecision(1) << seconds * 1000.0;
+      cells.push_back(ms.str());
+      fout << support << "," << algorithms[a] << "," << itemsets << "," << ms.str() << "\n";
+      skipped[a] = seconds > budget;
+    }
+    cout << setw(10) << support << setw(12) << itemsets;
+    for (const auto &cell : cells)
+      cout << setw(14) << cell;
+    cout << endl;
+  }
+  fout.close();
+  remove(output.c_str());
+  remove(input.c_str());
+
+  cout << "\nResults saved to frequent_itemsets_benchmark.csv" << endl;
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include "../common/numeric_parse.h"
+using namespace std;
+
+vector<string> makeColumn(size_t rows, int dirtyPercent)
+{
+  const char *dirty[] = {"N/A", "", "abc", "-", "null", "12kg"};
+  vector<string> cells;
+  cells.reserve(rows);
+  unsigned long long seed = 42;
+  for (size_t i = 0; i < rows; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    if ((int)((seed >> 33) % 100) < dirtyPercent)
+      cells.push_back(dirty[(seed >> 20) % 6]);
+    else
+      cells.push_back(to_string((seed >> 40) % 100000 / 100.0));
+  }
+  return cells;
+}
+
+double sumStod(const vector<string> &cells)
+{
+  double sum = 0;
+  for (const auto &cell : cells)
+  {
+    try
+    {
+      sum += stod(cell);
+    }
+    catch (...)
+    {
+    }
+  }
+  return sum;
+}
+
+double sumParseNumber(const vector<string> &cells)
+{
+  double sum = 0;
+  ColumnParseStats stats;
+  for (const auto &cell : cells)
+  {
+    double value;
+    if (stats.record(parseNumber(cell, value)) == ParseStatus::Ok)
+      sum += value;
+  }
+  return sum;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t rows = argc > 1 ? stoul(argv[1]) : 1000000;
+
+  ofstream fout("numeric_parse_benchmark.csv");
+  fout << "dirty_percent,method,best_ms,cells_per_s\n";
+  cout << right << setw(8) << "Dirty%" << setw(24) << "Method" << setw(12) << "ms" << setw(16) << "cells/s" << endl;
+  for (int dirtyPercent : {0, 1, 10, 50})
+  {
+    vector<string> cells = makeColumn(rows, dirtyPercent);
+    vector<pair<string, function<double()>>> methods = {
+        {"stod + try/catch", [&]() { return sumStod(cells); }},
+        {"parseNumber", [&]() { return sumParseNumber(cells); }}};
+    for (auto &method : methods)
+    {
+      double best = 1e30;
+      for (int run = 0; run < 3; run++)
+      {
+        auto start = chrono::steady_clock::now();
+        volatile double sink = method.second();
+        (void)sink;
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+      }
+      cout << setw(8) << dirtyPercent << setw(24) << method.first << setw(12) << fixed << setprecision(1)
+           << best * 1000.0 << setw(16) << setprecision(0) << rows / best << endl;
+      fout << dirtyPercent << "," << method.first << "," << best * 1000.0 << "," << rows / best << "\n";
+    }
+  }
+  fout.close();
+
+  cout << "\nResults saved to numeric_parse_benchmark.csv" << endl;
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <thread>
+#include "../common/csv_loader.h"
+#include "../common/cli_flags.h"
+#include "synthetic_data.h"
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+  string value;
+  int maxThreads = takeFlag(argc, argv, "--threads", value) ? atoi(value.c_str()) : (int)thread::hardware_concurrency();
+  if (maxThreads < 1)
+    maxThreads = 1;
+
+  string filename;
+  if (argc > 1 && string(argv[1]).find_first_not_of("0123456789") != string::npos)
+    filename = argv[1];
+  else
+  {
+    size_t rows = argc > 1 ? stoul(argv[1]) : 1000000;
+    cout << "Generating " << rows << " synthetic rows..." << endl;
+    filename = writeSyntheticCSV(rows);
+  }
+
+  vector<int> counts;
+  for (int t = 1; t < maxThreads; t *= 2)
+    counts.push_back(t);
+  counts.push_back(maxThreads);
+
+  ofstream fout("parallel_scaling.csv");
+  fout << "threads,rows,best_ms,mb_per_s,speedup\n";
+  cout << "Input: " << filename << "\n\n";
+  cout << setw(8) << "Threads" << setw(12) << "Rows" << setw(12) << "ms" << setw(12) << "MB/s" << setw(10) << "Speedup" << endl;
+
+  double baseline = 0;
+  for (int threads : counts)
+  {
+    double best = 1e30, mb = 0;
+    size_t rows = 0;
+    for (int run = 0; run < 3; run++)
+    {
+      CSVTable table;
+      if (!table.load(filename, threads))
+      {
+        cerr << "Error: Cannot open file " << filename << endl;
+        return 1;
+      }
+      best = min(best, table.seconds());
+      mb = table.bytes() / (1024.0 * 1024.0);
+      rows = table.rows();
+    }
+    if (threads == 1)
+      baseline = best;
+    cout << fixed << setprecision(1) << setw(8) << threads << setw(12) << rows << setw(12) << best * 1000.0
+         << setw(12) << mb / best << setw(9) << setprecision(2) << baseline / best << "x" << endl;
+    fout << threads << "," << rows << "," << best * 1000.0 << "," << mb / best << "," << baseline / best << "\n";
+  }
+  fout.close();
+
+  cout << "\nScaling curve saved to parallel_scaling.csv" << endl;
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include "../common/csv_loader.h"
+using namespace std;
+
+string writeStrayQuoteCSV(size_t rows)
+{
+  string filename = "synthetic_stray_quotes_" + to_string(rows) + ".csv";
+  ofstream out(filename, ios::binary);
+  const char *items[] = {"12\" pizza", "\"Large, 14\"\" pizza\"", "6\" sub", "\"two\nlines\"", "soda", "x\"y\"z"};
+  const char *ends[] = {"\n", "\r\n", "\r"};
+  out << "id,item,qty\n";
+  unsigned seed = 2024;
+  for (size_t i = 0; i < rows; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    out << i << "," << items[(seed >> 4) % 6] << "," << seed % 7 << ends[(seed >> 12) % 3];
+  }
+  return filename;
+}
+
+bool sameCells(const char *p, const vector<CellView> &a, const vector<size_t> &ra, const vector<CellView> &b,
+               const vector<size_t> &rb)
+{
+  if (a.size() != b.size() || ra != rb)
+    return false;
+  for (size_t i = 0; i < a.size(); i++)
+    if (a[i].length != b[i].length || a[i].escaped != b[i].escaped ||
+        memcmp(p + a[i].offset, p + b[i].offset, a[i].length) != 0)
+      return false;
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t rows = argc > 1 ? stoul(argv[1]) : 120000;
+  string filename = writeStrayQuoteCSV(rows);
+  MappedFile file;
+  if (!file.open(filename))
+  {
+    cerr << "Error: Cannot open file " << filename << endl;
+    return 1;
+  }
+
+  vector<CellView> serialCells;
+  vector<size_t> serialRows;
+  tokenizeRange(file.data(), 0, file.size(), 1, bestScanLevel(), serialCells, serialRows);
+
+  int failures = 0;
+  for (int threads = 2; threads <= 16; threads++)
+  {
+    vector<CellView> cells;
+    vector<size_t> rowStart;
+    tokenizeRange(file.data(), 0, file.size(), threads, bestScanLevel(), cells, rowStart);
+    bool ok = sameCells(file.data(), serialCells, serialRows, cells, rowStart);
+    cout << threads << " threads: " << rowStart.size() - 2 << " rows, " << (ok ? "ok" : "MISMATCH") << endl;
+    failures += !ok;
+  }
+
+  cout << "\nSerial load: " << serialRows.size() - 2 << " rows (expected " << rows << ")" << endl;
+  if (serialRows.size() - 2 != rows)
+    failures++;
+  cout << (failures ? "FAILED" : "PASSED") << endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+inline std::string writeSyntheticCSV(size_t rows)
+{
+  using namespace std;
+  string filename = "synthetic_" + to_string(rows) + ".csv";
+  ofstream out(filename, ios::binary);
+  const char *cities[] = {"Pune", "Mumbai", "\"New Delhi, NCR\"", "Nagpur", "\"Bengaluru\""};
+  const char *notes[] = {"ok", "\"said \"\"hi\"\"\"", "", "\"multi, field\"", "late"};
+  out << "id,name,city,score,amount,note,flag,date\n";
+  unsigned seed = 12345;
+  for (size_t i = 0; i < rows; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    out << i << ",user" << (seed % 9973) << "," << cities[seed % 5] << "," << (seed % 1000) / 10.0 << ","
+        << (seed % 100000) * 1.25 << "," << notes[(seed >> 8) % 5] << "," << (seed & 1) << ",2024-0"
+        << 1 + (seed % 9) << "-1" << (seed % 10) << "\n";
+  }
+  return filename;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+class BlockReader
+{
+public:
+  BlockReader() = default;
+  BlockReader(const BlockReader &) = delete;
+  BlockReader &operator=(const BlockReader &) = delete;
+  ~BlockReader() { close(); }
+
+  bool open(const std::string &path, size_t blockSize = 4 << 20, bool prefetch = true)
+  {
+    close();
+#ifdef _WIN32
+    fd = path == "-" ? _dup(0) : _open(path.c_str(), _O_RDONLY | _O_BINARY);
+    if (fd >= 0 && path == "-")
+      _setmode(fd, _O_BINARY);
+    streaming = path == "-";
+#else
+    fd = path == "-" ? dup(0) : ::open(path.c_str(), O_RDONLY);
+    streaming = fd >= 0 && lseek(fd, 0, SEEK_CUR) < 0;
+#endif
+    if (fd < 0)
+      return false;
+#if defined(POSIX_FADV_SEQUENTIAL)
+    if (!streaming)
+      posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    this->blockSize = blockSize ? blockSize : 1;
+    this->prefetch = prefetch && !streaming;
+    for (auto &block : blocks)
+    {
+      block.data.resize(this->blockSize);
+      block.size = 0;
+      block.ready = false;
+    }
+    current = 0;
+    position = 0;
+    offset = 0;
+    failed = stopping = false;
+    if (this->prefetch)
+      worker = std::thread(&BlockReader::run, this);
+    return true;
+  }
+
+  void close()
+  {
+    if (worker.joinable())
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      changed.notify_all();
+      worker.join();
+    }
+    if (fd >= 0)
+    {
+#ifdef _WIN32
+      _close(fd);
+#else
+      ::close(fd);
+#endif
+    }
+    fd = -1;
+  }
+
+  size_t read(char *out, size_t n)
+  {
+    size_t total = 0;
+    while (total < n && fd >= 0)
+    {
+      Block &block = blocks[current];
+      if (prefetch)
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return block.ready; });
+      }
+      else if (position == block.size)
+      {
+        if (streaming && total > 0)
+          break;
+        block.size = fill(block.data.data());
+        position = 0;
+      }
+      if (block.size == 0)
+        break;
+
+      size_t take = std::min(n - total, block.size - position);
+      memcpy(out + total, block.data.data() + position, take);
+      position += take;
+      total += take;
+      if (position == block.size && prefetch)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          block.ready = false;
+        }
+        changed.notify_all();
+        current ^= 1;
+        position = 0;
+      }
+    }
+    return total;
+  }
+
+  bool error() const { return failed; }
+  bool live() const { return streaming; }
+
+private:
+  struct Block
+  {
+    std::vector<char> data;
+    size_t size = 0;
+    bool ready = false;
+  };
+
+  int fd = -1;
+  size_t blockSize = 4 << 20;
+  bool prefetch = true;
+  bool streaming = false;
+  Block blocks[2];
+  int current = 0;
+  size_t position = 0;
+  size_t offset = 0;
+  std::atomic<bool> failed{false};
+  bool stopping = false;
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  size_t fill(char *out)
+  {
+    size_t total = 0;
+    while (total < blockSize)
+    {
+#ifdef _WIN32
+      int got = _read(fd, out + total, (unsigned)(blockSize - total));
+#else
+      ssize_t got = streaming ? ::read(fd, out + total, blockSize - total)
+                              : ::pread(fd, out + total, blockSize - total, (off_t)(offset + total));
+#endif
+      if (got < 0 && errno == EINTR)
+        continue;
+      if (got < 0)
+        failed = true;
+      if (got <= 0)
+        break;
+      total += got;
+      if (streaming)
+        break;
+    }
+    offset += total;
+    return total;
+  }
+
+  void run()
+  {
+    int next = 0;
+    while (true)
+    {
+      Block &block = blocks[next];
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return !block.ready || stopping; });
+        if (stopping)
+          return;
+      }
+      size_t size = fill(block.data.data());
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        block.size = size;
+        block.ready = true;
+      }
+      changed.notify_all();
+      if (size == 0)
+        return;
+      next ^= 1;
+    }
+  }
+};
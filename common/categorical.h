@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "csv_loader.h"
+
+class Dictionary
+{
+public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  Dictionary() = default;
+  Dictionary(const Dictionary &other) { *this = other; }
+  Dictionary &operator=(const Dictionary &other)
+  {
+    if (this != &other)
+    {
+      clear();
+      for (const auto &value : other.values)
+        intern(value);
+    }
+    return *this;
+  }
+
+  uint32_t intern(std::string_view value)
+  {
+    auto it = codes.find(value);
+    if (it != codes.end())
+      return it->second;
+    uint32_t code = (uint32_t)values.size();
+    values.emplace_back(value);
+    codes.emplace(values.back(), code);
+    return code;
+  }
+
+  uint32_t find(std::string_view value) const
+  {
+    auto it = codes.find(value);
+    return it == codes.end() ? npos : it->second;
+  }
+
+  const std::string &value(uint32_t code) const { return values[code]; }
+  size_t size() const { return values.size(); }
+
+  void clear()
+  {
+    codes.clear();
+    values.clear();
+  }
+
+  std::vector<uint32_t> sort()
+  {
+    std::vector<uint32_t> order(values.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+    std::deque<std::string> sorted;
+    std::vector<uint32_t> remap(values.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+      remap[order[i]] = i;
+      sorted.push_back(std::move(values[order[i]]));
+    }
+    values.swap(sorted);
+    codes.clear();
+    for (uint32_t i = 0; i < values.size(); i++)
+      codes.emplace(values[i], i);
+    return remap;
+  }
+
+private:
+  std::deque<std::string> values;
+  std::unordered_map<std::string_view, uint32_t> codes;
+};
+
+template <class Table>
+inline uint32_t internCell(Dictionary &dict, const Table &table, size_t r, size_t c)
+{
+  if (c >= table.width(r))
+    return dict.intern("");
+  return table.escaped(r, c) ? dict.intern(table.cellText(r, c)) : dict.intern(table.cell(r, c));
+}
+
+struct CategoricalColumn
+{
+  Dictionary dict;
+  std::vector<uint32_t> codes;
+
+  size_t levels() const { return dict.size(); }
+  const std::string &value(size_t r) const { return dict.value(codes[r]); }
+
+  void sortLevels()
+  {
+    std::vector<uint32_t> remap = dict.sort();
+    for (auto &code : codes)
+      code = remap[code];
+  }
+};
+
+inline std::vector<CategoricalColumn> loadCategorical(const CSVTable &table, bool sorted = true)
+{
+  std::vector<CategoricalColumn> columns(table.columns());
+  for (auto &column : columns)
+    column.codes.reserve(table.rows());
+  for (size_t r = 0; r < table.rows(); r++)
+    for (size_t c = 0; c < columns.size(); c++)
+      columns[c].codes.push_back(internCell(columns[c].dict, table, r, c));
+  if (sorted)
+    for (auto &column : columns)
+      column.sortLevels();
+  return columns;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+inline bool takeFlag(int &argc, char **argv, const std::string &name, std::string &value)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    int used = 0;
+    if (arg == name && i + 1 < argc)
+    {
+      value = argv[i + 1];
+      used = 2;
+    }
+    else if (arg.rfind(name + "=", 0) == 0)
+    {
+      value = arg.substr(name.size() + 1);
+      used = 1;
+    }
+    if (used)
+    {
+      for (int j = i; j + used < argc; j++)
+        argv[j] = argv[j + used];
+      argc -= used;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool takeSwitch(int &argc, char **argv, const std::string &name)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (argv[i] == name)
+    {
+      for (int j = i; j + 1 < argc; j++)
+        argv[j] = argv[j + 1];
+      argc--;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline int takeThreadsFlag(int &argc, char **argv)
+{
+  std::string value;
+  if (!takeFlag(argc, argv, "--threads", value))
+    return 1;
+  if (value == "auto")
+  {
+    int threads = (int)std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+  }
+  char *end = nullptr;
+  long threads = strtol(value.c_str(), &end, 10);
+  if (value.empty() || *end != '\0' || threads <= 0 || threads > 4096)
+    return 0;
+  return (int)threads;
+}
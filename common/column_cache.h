@@ -0,0 +1,453 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "csv_stream.h"
+#include "numeric_parse.h"
+
+const uint32_t DMCOL_VERSION = 2;
+const uint8_t DMCOL_MISSING = 3;
+const uint32_t DMCOL_NO_CODE = 0xFFFFFFFFu;
+const size_t DMCOL_GROUP_ROWS = 65536;
+
+enum class DmcolChunkType : uint32_t
+{
+  Numeric,
+  Dictionary
+};
+
+struct DmcolHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t columns;
+  uint64_t rows;
+  int64_t sourceMtime;
+  uint64_t sourceSize;
+  uint64_t naFingerprint;
+  uint64_t groupRows;
+  uint64_t groups;
+  uint64_t directoryOffset;
+};
+
+struct DmcolColumn
+{
+  uint64_t nameOffset;
+  uint64_t nameLength;
+  uint64_t valid;
+  uint64_t nulls;
+  uint64_t invalid;
+};
+
+struct DmcolChunk
+{
+  DmcolChunkType type;
+  uint32_t rows;
+  uint64_t dataOffset;
+  uint64_t statusOffset;
+  uint64_t dictOffset;
+  uint64_t dictCount;
+};
+
+inline bool sourceStamp(const std::string &path, int64_t &mtime, uint64_t &size)
+{
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return false;
+#ifdef __linux__
+  mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+  mtime = (int64_t)st.st_mtime;
+#endif
+  size = (uint64_t)st.st_size;
+  return true;
+}
+
+class DmcolWriter
+{
+public:
+  explicit DmcolWriter(const std::string &path) : out(path, std::ios::binary | std::ios::trunc) {}
+  DmcolWriter() = default;
+
+  bool toFile() const { return out.is_open(); }
+  bool good() const { return !toFile() || (bool)out; }
+  uint64_t position() const { return written; }
+  std::string &memory() { return image; }
+
+  void write(const void *p, size_t n)
+  {
+    if (toFile())
+      out.write((const char *)p, n);
+    else
+      image.append((const char *)p, n);
+    written += n;
+  }
+
+  void pad()
+  {
+    static const char zeros[8] = {0};
+    if (written % 8)
+      write(zeros, 8 - written % 8);
+  }
+
+  void patch(uint64_t offset, const void *p, size_t n)
+  {
+    if (toFile())
+    {
+      out.seekp(offset);
+      out.write((const char *)p, n);
+      out.seekp(0, std::ios::end);
+    }
+    else
+      memcpy(&image[offset], p, n);
+  }
+
+  void close()
+  {
+    if (toFile())
+      out.close();
+  }
+
+private:
+  std::ofstream out;
+  std::string image;
+  uint64_t written = 0;
+};
+
+class ColumnCache
+{
+public:
+  bool open(const std::string &csvPath, int threads = 1)
+  {
+    auto start = std::chrono::steady_clock::now();
+    image.clear();
+    cacheFile.close();
+    base = nullptr;
+    meta = nullptr;
+    cachePath = csvPath + ".dmcol";
+    int64_t mtime;
+    uint64_t size;
+    if (!sourceStamp(csvPath, mtime, size))
+      return false;
+
+    fromFile = mapCache(mtime, size);
+    written = false;
+    if (!fromFile)
+    {
+      std::string tmpPath = cachePath + ".tmp";
+      DmcolWriter file(tmpPath);
+      if (file.toFile() && build(csvPath, threads, mtime, size, file))
+      {
+        file.close();
+        std::remove(cachePath.c_str());
+        written = std::rename(tmpPath.c_str(), cachePath.c_str()) == 0 && mapCache(mtime, size);
+      }
+      else
+        file.close();
+      std::remove(tmpPath.c_str());
+      if (!written)
+      {
+        DmcolWriter memory;
+        if (!build(csvPath, threads, mtime, size, memory))
+          return false;
+        image.swap(memory.memory());
+        base = image.data();
+      }
+    }
+    meta = (const DmcolHeader *)base;
+    directory = (const DmcolColumn *)(base + meta->directoryOffset);
+    chunks = (const DmcolChunk *)(directory + meta->columns);
+    dictNumbers.assign(meta->groups * meta->columns, {});
+    loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+  }
+
+  size_t rows() const { return meta ? meta->rows : 0; }
+  size_t columns() const { return meta ? meta->columns : 0; }
+
+  std::string header(size_t c) const
+  {
+    return std::string(base + directory[c].nameOffset, directory[c].nameLength);
+  }
+
+  std::vector<std::string> headerNames() const
+  {
+    std::vector<std::string> names;
+    for (size_t c = 0; c < columns(); c++)
+      names.push_back(header(c));
+    return names;
+  }
+
+  std::vector<ColumnParseStats> stats() const
+  {
+    std::vector<ColumnParseStats> out(columns());
+    for (size_t c = 0; c < columns(); c++)
+    {
+      out[c].valid = directory[c].valid;
+      out[c].nulls = directory[c].nulls;
+      out[c].invalid = directory[c].invalid;
+    }
+    return out;
+  }
+
+  bool present(size_t r, size_t c) const
+  {
+    const DmcolChunk &chunk = chunkFor(r, c);
+    size_t i = r % meta->groupRows;
+    if (chunk.type == DmcolChunkType::Numeric)
+      return (uint8_t)base[chunk.statusOffset + i] != DMCOL_MISSING;
+    return ((const uint32_t *)(base + chunk.dataOffset))[i] != DMCOL_NO_CODE;
+  }
+
+  ParseStatus number(size_t r, size_t c, double &value) const
+  {
+    size_t g = r / meta->groupRows, i = r % meta->groupRows;
+    const DmcolChunk &chunk = chunks[g * meta->columns + c];
+    if (chunk.type == DmcolChunkType::Numeric)
+    {
+      uint8_t status = (uint8_t)base[chunk.statusOffset + i];
+      if (status == DMCOL_MISSING)
+        return ParseStatus::Null;
+      value = ((const double *)(base + chunk.dataOffset))[i];
+      return (ParseStatus)status;
+    }
+    uint32_t code = ((const uint32_t *)(base + chunk.dataOffset))[i];
+    if (code == DMCOL_NO_CODE)
+      return ParseStatus::Null;
+    const auto &parsed = dictionaryNumbers(g * meta->columns + c);
+    value = parsed[code].second;
+    return parsed[code].first;
+  }
+
+  std::vector<double> numbers(size_t c) const
+  {
+    std::vector<double> out;
+    out.reserve(directory[c].valid);
+    for (size_t r = 0; r < rows(); r++)
+    {
+      double value;
+      if (number(r, c, value) == ParseStatus::Ok)
+        out.push_back(value);
+    }
+    return out;
+  }
+
+  bool fromCache() const { return fromFile; }
+  double seconds() const { return loadSeconds; }
+
+  void printLoadStats(std::ostream &out = std::cout) const
+  {
+    char line[512];
+    if (fromFile)
+      snprintf(line, sizeof(line), "Load: %zu rows x %zu columns from %s in %.2f ms", rows(), columns(),
+               cachePath.c_str(), loadSeconds * 1000.0);
+    else
+      snprintf(line, sizeof(line), "Load: %zu rows x %zu columns parsed in %.2f ms (%s)", rows(), columns(),
+               loadSeconds * 1000.0, written ? ("cache written to " + cachePath).c_str() : "cache not written");
+    out << line << std::endl;
+  }
+
+private:
+  MappedFile cacheFile;
+  std::string image;
+  std::string cachePath;
+  const char *base = nullptr;
+  const DmcolHeader *meta = nullptr;
+  const DmcolColumn *directory = nullptr;
+  const DmcolChunk *chunks = nullptr;
+  mutable std::vector<std::vector<std::pair<ParseStatus, double>>> dictNumbers;
+  bool fromFile = false;
+  bool written = false;
+  double loadSeconds = 0.0;
+
+  const DmcolChunk &chunkFor(size_t r, size_t c) const { return chunks[r / meta->groupRows * meta->columns + c]; }
+
+  const std::vector<std::pair<ParseStatus, double>> &dictionaryNumbers(size_t index) const
+  {
+    auto &parsed = dictNumbers[index];
+    const DmcolChunk &chunk = chunks[index];
+    if (parsed.empty() && chunk.dictCount)
+    {
+      const uint64_t *offsets = (const uint64_t *)(base + chunk.dictOffset);
+      const char *blob = (const char *)(offsets + chunk.dictCount + 1);
+      parsed.resize(chunk.dictCount);
+      for (size_t i = 0; i < parsed.size(); i++)
+      {
+        std::string_view text(blob + offsets[i], offsets[i + 1] - offsets[i]);
+        parsed[i].second = 0.0;
+        parsed[i].first = parseNumber(text, parsed[i].second);
+      }
+    }
+    return parsed;
+  }
+
+  bool mapCache(int64_t mtime, uint64_t size)
+  {
+    if (!cacheFile.open(cachePath, false))
+      return false;
+    if (!validCache(cacheFile.data(), cacheFile.size(), mtime, size))
+    {
+      cacheFile.close();
+      return false;
+    }
+    base = cacheFile.data();
+    return true;
+  }
+
+  static bool validCache(const char *p, size_t n, int64_t mtime, uint64_t size)
+  {
+    DmcolHeader h;
+    if (n < sizeof(h))
+      return false;
+    memcpy(&h, p, sizeof(h));
+    if (memcmp(h.magic, "DMCOL\0\0\0", 8) != 0 || h.version != DMCOL_VERSION || h.sourceMtime != mtime ||
+        h.sourceSize != size || h.naFingerprint != naTokens().fingerprint())
+      return false;
+    if (h.groupRows == 0 || h.groups != (h.rows + h.groupRows - 1) / h.groupRows || h.directoryOffset % 8 ||
+        h.directoryOffset + h.columns * sizeof(DmcolColumn) + h.groups * h.columns * sizeof(DmcolChunk) > n)
+      return false;
+    const DmcolColumn *dir = (const DmcolColumn *)(p + h.directoryOffset);
+    for (size_t c = 0; c < h.columns; c++)
+      if (dir[c].nameOffset + dir[c].nameLength > n)
+        return false;
+    const DmcolChunk *chunk = (const DmcolChunk *)(dir + h.columns);
+    for (size_t i = 0; i < h.groups * h.columns; i++, chunk++)
+    {
+      uint64_t groupRows = i / h.columns + 1 < h.groups ? h.groupRows : h.rows - (h.groups - 1) * h.groupRows;
+      bool fits = chunk->rows == groupRows;
+      if (chunk->type == DmcolChunkType::Numeric)
+        fits = fits && chunk->dataOffset + groupRows * 8 <= n && chunk->statusOffset + groupRows <= n;
+      else
+      {
+        uint64_t blob = chunk->dictOffset + (chunk->dictCount + 1) * 8;
+        fits = fits && chunk->dataOffset + groupRows * 4 <= n && blob <= n &&
+               blob + ((const uint64_t *)(p + chunk->dictOffset))[chunk->dictCount] <= n;
+      }
+      if (!fits)
+        return false;
+    }
+    return true;
+  }
+
+  bool build(const std::string &csvPath, int threads, int64_t mtime, uint64_t size, DmcolWriter &out)
+  {
+    CSVStream stream;
+    if (!stream.open(csvPath, DMCOL_GROUP_ROWS, threads))
+      return false;
+    size_t columnCount = stream.columns();
+
+    DmcolHeader h{};
+    memcpy(h.magic, "DMCOL\0\0\0", 8);
+    h.version = DMCOL_VERSION;
+    h.columns = (uint32_t)columnCount;
+    h.sourceMtime = mtime;
+    h.sourceSize = size;
+    h.naFingerprint = naTokens().fingerprint();
+    h.groupRows = DMCOL_GROUP_ROWS;
+    out.write(&h, sizeof(h));
+
+    std::vector<ColumnParseStats> stats(columnCount);
+    std::vector<DmcolChunk> chunkList;
+    std::vector<std::vector<double>> values(columnCount);
+    std::vector<std::vector<uint8_t>> status(columnCount);
+    std::vector<uint32_t> codes(DMCOL_GROUP_ROWS);
+    while (stream.next())
+    {
+      size_t n = stream.rows();
+      std::vector<ColumnParseStats> chunkStats(columnCount);
+      for (size_t c = 0; c < columnCount; c++)
+      {
+        values[c].assign(n, 0.0);
+        status[c].assign(n, DMCOL_MISSING);
+      }
+      for (size_t r = 0; r < n; r++)
+      {
+        size_t w = stream.width(r) < columnCount ? stream.width(r) : columnCount;
+        for (size_t c = 0; c < w; c++)
+          status[c][r] = (uint8_t)chunkStats[c].record(parseNumber(stream.cell(r, c), values[c][r]));
+      }
+
+      for (size_t c = 0; c < columnCount; c++)
+      {
+        DmcolChunk chunk{};
+        chunk.rows = (uint32_t)n;
+        stats[c].valid += chunkStats[c].valid;
+        stats[c].nulls += chunkStats[c].nulls;
+        stats[c].invalid += chunkStats[c].invalid;
+
+        if (!chunkStats[c].invalid)
+        {
+          chunk.type = DmcolChunkType::Numeric;
+          chunk.dataOffset = out.position();
+          out.write(values[c].data(), n * sizeof(double));
+          chunk.statusOffset = out.position();
+          out.write(status[c].data(), n);
+          out.pad();
+        }
+        else
+        {
+          chunk.type = DmcolChunkType::Dictionary;
+          std::unordered_map<std::string, uint32_t> ids;
+          std::vector<const std::string *> entries;
+          for (size_t r = 0; r < n; r++)
+          {
+            codes[r] = DMCOL_NO_CODE;
+            if (status[c][r] == DMCOL_MISSING)
+              continue;
+            auto it = ids.emplace(stream.cellText(r, c), (uint32_t)entries.size());
+            if (it.second)
+              entries.push_back(&it.first->first);
+            codes[r] = it.first->second;
+          }
+          chunk.dataOffset = out.position();
+          out.write(codes.data(), n * sizeof(uint32_t));
+          out.pad();
+          chunk.dictOffset = out.position();
+          chunk.dictCount = entries.size();
+          std::vector<uint64_t> offsets(1, 0);
+          for (const auto *e : entries)
+            offsets.push_back(offsets.back() + e->size());
+          out.write(offsets.data(), offsets.size() * sizeof(uint64_t));
+          for (const auto *e : entries)
+            out.write(e->data(), e->size());
+          out.pad();
+        }
+        chunkList.push_back(chunk);
+      }
+      h.rows += n;
+      h.groups++;
+      if (!out.good())
+        return false;
+    }
+
+    std::vector<DmcolColumn> dir(columnCount);
+    for (size_t c = 0; c < columnCount; c++)
+    {
+      std::string name(stream.header(c));
+      dir[c].nameOffset = out.position();
+      dir[c].nameLength = name.size();
+      dir[c].valid = stats[c].valid;
+      dir[c].nulls = stats[c].nulls;
+      dir[c].invalid = stats[c].invalid;
+      out.write(name.data(), name.size());
+    }
+    out.pad();
+    h.directoryOffset = out.position();
+    out.write(dir.data(), dir.size() * sizeof(DmcolColumn));
+    out.write(chunkList.data(), chunkList.size() * sizeof(DmcolChunk));
+    out.patch(0, &h, sizeof(h));
+    return out.good();
+  }
+};
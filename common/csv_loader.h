@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "csv_tokenizer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { close(); }
+
+  bool open(const std::string &path, bool sequential = true)
+  {
+    close();
+#ifdef _WIN32
+    handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+      return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize))
+    {
+      close();
+      return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0)
+      return true;
+    mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+      close();
+      return false;
+    }
+    base = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+      close();
+      return false;
+    }
+    length = (size_t)st.st_size;
+    if (length == 0)
+      return true;
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (sequential)
+      flags |= MAP_POPULATE;
+#endif
+    void *p = mmap(nullptr, length, PROT_READ, flags, fd, 0);
+    if (p == MAP_FAILED)
+    {
+      close();
+      return false;
+    }
+    if (sequential)
+      madvise(p, length, MADV_SEQUENTIAL);
+    base = (const char *)p;
+#endif
+    if (!base)
+    {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close()
+  {
+#ifdef _WIN32
+    if (base)
+      UnmapViewOfFile(base);
+    if (mapping)
+      CloseHandle(mapping);
+    if (handle != INVALID_HANDLE_VALUE)
+      CloseHandle(handle);
+    mapping = nullptr;
+    handle = INVALID_HANDLE_VALUE;
+#else
+    if (base)
+      munmap((void *)base, length);
+    if (fd >= 0)
+      ::close(fd);
+    fd = -1;
+#endif
+    base = nullptr;
+    length = 0;
+  }
+
+  const char *data() const { return base; }
+  size_t size() const { return length; }
+
+private:
+  const char *base = nullptr;
+  size_t length = 0;
+#ifdef _WIN32
+  HANDLE handle = INVALID_HANDLE_VALUE;
+  HANDLE mapping = nullptr;
+#else
+  int fd = -1;
+#endif
+};
+
+inline std::string_view trimView(std::string_view s)
+{
+  size_t start = s.find_first_not_of(" \t\r\n");
+  if (start == std::string_view::npos)
+    return std::string_view();
+  size_t end = s.find_last_not_of(" \t\r\n");
+  return s.substr(start, end - start + 1);
+}
+
+inline std::string unescapeCell(std::string_view s)
+{
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); i++)
+  {
+    out += s[i];
+    if (s[i] == '"' && i + 1 < s.size() && s[i + 1] == '"')
+      i++;
+  }
+  return out;
+}
+
+inline int tokenizeThreads(size_t bytes, int threads)
+{
+  size_t minChunk = 1 << 20;
+  if (threads > (int)(bytes / minChunk))
+    threads = (int)(bytes / minChunk);
+  return threads > 1 ? threads : 1;
+}
+
+inline size_t tokenizeRange(const char *p, size_t begin, size_t n, int threads, ScanLevel level,
+                            std::vector<CellView> &cells, std::vector<size_t> &rowStart,
+                            std::vector<size_t> *rowOffsets = nullptr, bool partial = false)
+{
+  cells.reserve(cells.size() + estimateCells(p + begin, n - begin));
+  if (threads <= 1)
+  {
+    CSVTokenizer tokenizer(cells, rowStart);
+    if (rowOffsets)
+      tokenizer.trackRowOffsets(*rowOffsets);
+    if (partial)
+      return tokenizer.runPartial(p, begin, n, level);
+    tokenizer.run(p, begin, n, level);
+    return n;
+  }
+
+  auto cut = [&](int t) { return begin + (n - begin) * t / threads; };
+  std::vector<size_t> quotes(threads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back([&, t]() { quotes[t] = countQuotes(p, cut(t), cut(t + 1), n, level); });
+  for (auto &w : workers)
+    w.join();
+  workers.clear();
+
+  std::vector<size_t> bounds(threads + 1, begin);
+  bounds[threads] = n;
+  size_t quotesBefore = 0;
+  for (int t = 1; t < threads; t++)
+  {
+    quotesBefore += quotes[t - 1];
+    bounds[t] = nextRecordStart(p, cut(t), n, quotesBefore % 2 == 1);
+    if (bounds[t] < bounds[t - 1])
+      bounds[t] = bounds[t - 1];
+  }
+
+  size_t cellsBefore = cells.size(), rowsBefore = rowStart.size(), offsetsBefore = rowOffsets ? rowOffsets->size() : 0;
+  std::vector<std::vector<CellView>> localCells(threads);
+  std::vector<std::vector<size_t>> localRows(threads), localOffsets(threads);
+  std::vector<size_t> tails(threads, n);
+  std::vector<char> aligned(threads, 1);
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back([&, t]() {
+      std::vector<CellView> &out = t == 0 ? cells : localCells[t];
+      std::vector<size_t> &rows = t == 0 ? rowStart : localRows[t];
+      if (t > 0)
+        out.reserve(estimateCells(p + bounds[t], bounds[t + 1] - bounds[t]));
+      CSVTokenizer tokenizer(out, rows);
+      if (rowOffsets)
+        tokenizer.trackRowOffsets(t == 0 ? *rowOffsets : localOffsets[t]);
+      if (partial && bounds[t + 1] == n)
+        tails[t] = tokenizer.runPartial(p, bounds[t], bounds[t + 1], level);
+      else
+      {
+        tokenizer.run(p, bounds[t], bounds[t + 1], level);
+        aligned[t] = t + 1 == threads || tokenizer.lastRecordStart() == bounds[t + 1];
+      }
+    });
+  for (auto &w : workers)
+    w.join();
+  workers.clear();
+
+  if (std::find(aligned.begin(), aligned.end(), 0) != aligned.end())
+  {
+    cells.resize(cellsBefore);
+    rowStart.resize(rowsBefore);
+    if (rowOffsets)
+      rowOffsets->resize(offsetsBefore);
+    return tokenizeRange(p, begin, n, 1, level, cells, rowStart, rowOffsets, partial);
+  }
+
+  std::vector<size_t> cellBase(threads + 1, cells.size()), rowBase(threads + 1, rowStart.size());
+  for (int t = 1; t < threads; t++)
+  {
+    cellBase[t + 1] = cellBase[t] + localCells[t].size();
+    rowBase[t + 1] = rowBase[t] + localRows[t].size() - 1;
+  }
+  cells.resize(cellBase[threads]);
+  rowStart.resize(rowBase[threads]);
+  for (int t = 1; t < threads; t++)
+    workers.emplace_back([&, t]() {
+      std::copy(localCells[t].begin(), localCells[t].end(), cells.begin() + cellBase[t]);
+      for (size_t r = 1; r < localRows[t].size(); r++)
+        rowStart[rowBase[t] + r - 1] = localRows[t][r] + cellBase[t];
+      std::vector<CellView>().swap(localCells[t]);
+    });
+  for (auto &w : workers)
+    w.join();
+  if (rowOffsets)
+    for (int t = 1; t < threads; t++)
+      rowOffsets->insert(rowOffsets->end(), localOffsets[t].begin(), localOffsets[t].end());
+  return *std::min_element(tails.begin(), tails.end());
+}
+
+class CSVTable
+{
+public:
+  bool load(const std::string &path, int threads = 1, ScanLevel level = bestScanLevel())
+  {
+    auto start = std::chrono::steady_clock::now();
+    cells.clear();
+    rowStart.clear();
+    if (!file.open(path))
+      return false;
+    usedThreads = tokenizeThreads(file.size(), threads);
+    tokenizeRange(file.data(), 0, file.size(), usedThreads, level, cells, rowStart);
+    if (rowStart.size() == 1)
+      rowStart.push_back(0);
+    loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+  }
+
+  size_t rows() const { return rowStart.empty() ? 0 : rowStart.size() - 2; }
+  size_t columns() const { return rowStart.empty() ? 0 : rowStart[1]; }
+  size_t width(size_t r) const { return rowStart[r + 2] - rowStart[r + 1]; }
+
+  std::string_view header(size_t c) const { return view(cells[c]); }
+  std::string_view cell(size_t r, size_t c) const { return view(cells[rowStart[r + 1] + c]); }
+  bool escaped(size_t r, size_t c) const { return cells[rowStart[r + 1] + c].escaped; }
+
+  std::string headerText(size_t c) const { return text(cells[c]); }
+  std::string cellText(size_t r, size_t c) const { return text(cells[rowStart[r + 1] + c]); }
+
+  std::vector<std::string> headerNames(bool trimmed = false) const
+  {
+    std::vector<std::string> names;
+    for (size_t c = 0; c < columns(); c++)
+    {
+      std::string name = headerText(c);
+      names.push_back(trimmed ? std::string(trimView(name)) : name);
+    }
+    return names;
+  }
+
+  std::vector<std::string> rowText(size_t r, bool trimmed = false) const
+  {
+    std::vector<std::string> row;
+    for (size_t c = 0; c < width(r); c++)
+    {
+      std::string value = cellText(r, c);
+      row.push_back(trimmed ? std::string(trimView(value)) : value);
+    }
+    return row;
+  }
+
+  size_t bytes() const { return file.size(); }
+  int threads() const { return usedThreads; }
+  double seconds() const { return loadSeconds; }
+
+  void printLoadStats(std::ostream &out = std::cout) const
+  {
+    double mb = bytes() / (1024.0 * 1024.0);
+    char line[128];
+    snprintf(line, sizeof(line), "Load: %.2f MB in %.2f ms (%.1f MB/s, %d thread%s)", mb, loadSeconds * 1000.0,
+             loadSeconds > 0 ? mb / loadSeconds : 0.0, usedThreads, usedThreads == 1 ? "" : "s");
+    out << line << std::endl;
+  }
+
+private:
+  MappedFile file;
+  std::vector<CellView> cells;
+  std::vector<size_t> rowStart;
+  double loadSeconds = 0.0;
+  int usedThreads = 1;
+
+  std::string_view view(const CellView &c) const { return std::string_view(file.data() + c.offset, c.length); }
+  std::string text(const CellView &c) const { return c.escaped ? unescapeCell(view(c)) : std::string(view(c)); }
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "block_reader.h"
+#include "csv_loader.h"
+
+class CSVStream
+{
+public:
+  CSVStream() = default;
+  CSVStream(const CSVStream &) = delete;
+  CSVStream &operator=(const CSVStream &) = delete;
+  ~CSVStream() { close(); }
+
+  bool open(const std::string &path, size_t batchRows = 65536, int threads = 1)
+  {
+    close();
+    if (!reader.open(path))
+      return false;
+    opened = true;
+    this->batchRows = batchRows ? batchRows : 1;
+    this->threads = threads;
+    refill();
+    if (completeRows > 0)
+    {
+      for (size_t c = 0; c < rowWidth(0); c++)
+        names.push_back(text(cells[rowStart[0] + c]));
+      cursor = 1;
+    }
+    return true;
+  }
+
+  void close()
+  {
+    reader.close();
+    opened = false;
+    eof = false;
+    buffer.clear();
+    length = tail = 0;
+    cells.clear();
+    rowStart.clear();
+    rowOffsets.clear();
+    names.clear();
+    completeRows = cursor = batchBegin = batchCount = 0;
+    bytesRead = rowsRead = 0;
+    loadSeconds = 0.0;
+  }
+
+  size_t columns() const { return names.size(); }
+  std::string_view header(size_t c) const { return names[c]; }
+
+  std::vector<std::string> headerNames(bool trimmed = false) const
+  {
+    std::vector<std::string> out;
+    for (const auto &name : names)
+      out.push_back(trimmed ? std::string(trimView(name)) : name);
+    return out;
+  }
+
+  bool next()
+  {
+    if (!opened)
+      return false;
+    if (completeRows - cursor < (reader.live() ? 1 : batchRows) && !eof)
+      refill();
+    if (cursor >= completeRows)
+      return false;
+    batchBegin = cursor;
+    batchCount = completeRows - cursor < batchRows ? completeRows - cursor : batchRows;
+    cursor += batchCount;
+    rowsRead += batchCount;
+    return true;
+  }
+
+  size_t rows() const { return batchCount; }
+  size_t width(size_t r) const { return rowWidth(batchBegin + r); }
+  std::string_view cell(size_t r, size_t c) const { return view(cells[rowStart[batchBegin + r] + c]); }
+  bool escaped(size_t r, size_t c) const { return cells[rowStart[batchBegin + r] + c].escaped; }
+  std::string cellText(size_t r, size_t c) const { return text(cells[rowStart[batchBegin + r] + c]); }
+
+  std::vector<std::string> rowText(size_t r, bool trimmed = false) const
+  {
+    std::vector<std::string> row;
+    for (size_t c = 0; c < width(r); c++)
+    {
+      std::string value = cellText(r, c);
+      row.push_back(trimmed ? std::string(trimView(value)) : value);
+    }
+    return row;
+  }
+
+  size_t bytes() const { return bytesRead; }
+  size_t totalRows() const { return rowsRead; }
+  size_t batchSize() const { return batchRows; }
+  double seconds() const { return loadSeconds; }
+
+  void printLoadStats(std::ostream &out = std::cout) const
+  {
+    double mb = bytes() / (1024.0 * 1024.0);
+    char line[160];
+    snprintf(line, sizeof(line), "Load: %.2f MB streamed in %.2f ms (%.1f MB/s, %zu-row batches, %.1f MB buffer)",
+             mb, loadSeconds * 1000.0, loadSeconds > 0 ? mb / loadSeconds : 0.0, batchRows,
+             buffer.size() / (1024.0 * 1024.0));
+    out << line << std::endl;
+  }
+
+private:
+  BlockReader reader;
+  bool opened = false;
+  bool eof = false;
+  std::vector<char> buffer;
+  size_t length = 0;
+  size_t tail = 0;
+  std::vector<CellView> cells;
+  std::vector<size_t> rowStart;
+  std::vector<size_t> rowOffsets;
+  std::vector<std::string> names;
+  size_t batchRows = 65536;
+  int threads = 1;
+  size_t completeRows = 0;
+  size_t cursor = 0;
+  size_t batchBegin = 0;
+  size_t batchCount = 0;
+  size_t bytesRead = 0;
+  size_t rowsRead = 0;
+  double loadSeconds = 0.0;
+
+  size_t rowWidth(size_t r) const { return rowStart[r + 1] - rowStart[r]; }
+
+  void refill()
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t keep = cursor < completeRows ? rowOffsets[cursor] : tail;
+    if (keep > length)
+      keep = length;
+    if (buffer.empty())
+      buffer.resize(1 << 20);
+    memmove(buffer.data(), buffer.data() + keep, length - keep);
+    length -= keep;
+
+    cells.clear();
+    rowStart.clear();
+    rowOffsets.clear();
+    tail = 0;
+    while (true)
+    {
+      while (!eof && length < buffer.size())
+      {
+        size_t got = reader.read(buffer.data() + length, buffer.size() - length);
+        if (got == 0)
+          eof = true;
+        length += got;
+        bytesRead += got;
+        if (reader.live())
+          break;
+      }
+      tail = tokenizeRange(buffer.data(), tail, length, tokenizeThreads(length - tail, threads), bestScanLevel(), cells,
+                           rowStart, &rowOffsets, !eof);
+      if (rowStart.empty())
+        rowStart.push_back(0);
+      completeRows = rowStart.size() - 1;
+      cursor = 0;
+      if (eof || completeRows >= batchRows || (reader.live() && completeRows > 0))
+        break;
+      if (length == buffer.size())
+        buffer.resize(buffer.size() * 2);
+    }
+    loadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  std::string_view view(const CellView &c) const { return std::string_view(buffer.data() + c.offset, c.length); }
+  std::string text(const CellView &c) const { return c.escaped ? unescapeCell(view(c)) : std::string(view(c)); }
+};
@@ -0,0 +1,355 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CSV_TOKENIZER_X86 1
+#include <immintrin.h>
+#endif
+
+struct CellView
+{
+  uint64_t offset;
+  uint32_t length;
+  uint32_t escaped;
+};
+
+enum class ScanLevel
+{
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+inline const char *scanLevelName(ScanLevel level)
+{
+  switch (level)
+  {
+  case ScanLevel::AVX2:
+    return "AVX2";
+  case ScanLevel::SSE2:
+    return "SSE2";
+  default:
+    return "scalar";
+  }
+}
+
+struct StructuralMasks
+{
+  uint64_t separator;
+  uint64_t quote;
+  uint64_t newline;
+};
+
+inline StructuralMasks structuralMasksScalar(const char *p)
+{
+  StructuralMasks m{0, 0, 0};
+  for (int i = 0; i < 64; i++)
+  {
+    char c = p[i];
+    if (c == ',')
+      m.separator |= 1ULL << i;
+    else if (c == '"')
+      m.quote |= 1ULL << i;
+    else if (c == '\n' || c == '\r')
+      m.newline |= 1ULL << i;
+  }
+  return m;
+}
+
+#ifdef CSV_TOKENIZER_X86
+__attribute__((target("sse2"))) inline StructuralMasks structuralMasksSSE2(const char *p)
+{
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  StructuralMasks m{0, 0, 0};
+  for (int i = 0; i < 4; i++)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+    m.separator |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)) << (16 * i);
+    m.quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << (16 * i);
+    __m128i eol = _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr));
+    m.newline |= (uint64_t)(uint16_t)_mm_movemask_epi8(eol) << (16 * i);
+  }
+  return m;
+}
+
+__attribute__((target("avx2"))) inline StructuralMasks structuralMasksAVX2(const char *p)
+{
+  const __m256i comma = _mm256_set1_epi8(',');
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  StructuralMasks m{0, 0, 0};
+  for (int i = 0; i < 2; i++)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(p + 32 * i));
+    m.separator |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, comma)) << (32 * i);
+    m.quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)) << (32 * i);
+    __m256i eol = _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr));
+    m.newline |= (uint64_t)(uint32_t)_mm256_movemask_epi8(eol) << (32 * i);
+  }
+  return m;
+}
+#endif
+
+inline ScanLevel detectScanLevel()
+{
+#ifdef CSV_TOKENIZER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return ScanLevel::AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return ScanLevel::SSE2;
+#endif
+  return ScanLevel::Scalar;
+}
+
+inline ScanLevel bestScanLevel()
+{
+  static const ScanLevel level = detectScanLevel();
+  return level;
+}
+
+inline StructuralMasks structuralMasks(const char *p, ScanLevel level)
+{
+#ifdef CSV_TOKENIZER_X86
+  if (level == ScanLevel::AVX2)
+    return structuralMasksAVX2(p);
+  if (level == ScanLevel::SSE2)
+    return structuralMasksSSE2(p);
+#endif
+  return structuralMasksScalar(p);
+}
+
+inline int popCount(uint64_t mask)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(mask);
+#else
+  int count = 0;
+  for (; mask; mask &= mask - 1)
+    count++;
+  return count;
+#endif
+}
+
+inline int lowestBit(uint64_t mask)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(mask);
+#else
+  int i = 0;
+  while (!(mask & 1))
+  {
+    mask >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+inline bool isFieldEdge(char c) { return c == ',' || c == '\n' || c == '\r'; }
+
+inline size_t countQuotes(const char *p, size_t begin, size_t end, size_t n, ScanLevel level)
+{
+  size_t quotes = 0;
+  uint64_t before = begin == 0 || isFieldEdge(p[begin - 1]);
+  size_t pos = begin;
+  for (; pos + 64 <= end; pos += 64)
+  {
+    StructuralMasks m = structuralMasks(p + pos, level);
+    uint64_t edge = m.separator | m.newline;
+    uint64_t after = pos + 64 >= n || isFieldEdge(p[pos + 64]);
+    quotes += popCount(m.quote & ((edge << 1) | before | (edge >> 1) | (after << 63)));
+    before = edge >> 63;
+  }
+  for (; pos < end; pos++)
+    if (p[pos] == '"' && (pos == 0 || isFieldEdge(p[pos - 1]) || pos + 1 >= n || isFieldEdge(p[pos + 1])))
+      quotes++;
+  return quotes;
+}
+
+inline size_t nextRecordStart(const char *p, size_t pos, size_t n, bool inQuotes)
+{
+  for (; pos < n; pos++)
+  {
+    if (inQuotes)
+    {
+      if (p[pos] == '"')
+      {
+        if (pos + 1 < n && p[pos + 1] == '"')
+          pos++;
+        else
+          inQuotes = false;
+      }
+    }
+    else if (p[pos] == '"')
+      inQuotes = pos == 0 || isFieldEdge(p[pos - 1]);
+    else if (p[pos] == '\n' || p[pos] == '\r')
+      return pos + 1;
+  }
+  return n;
+}
+
+inline size_t estimateCells(const char *p, size_t n)
+{
+  size_t sample = n < (1 << 20) ? n : (1 << 20);
+  size_t separators = 1;
+  for (size_t i = 0; i < sample; i++)
+    separators += p[i] == ',' || p[i] == '\n';
+  return (size_t)((double)separators * n / (sample ? sample : 1) * 1.05) + 16;
+}
+
+class CSVTokenizer
+{
+public:
+  CSVTokenizer(std::vector<CellView> &cells, std::vector<size_t> &rowStart) : cells(cells), rowStart(rowStart)
+  {
+    if (rowStart.empty())
+      rowStart.push_back(cells.size());
+  }
+
+  void trackRowOffsets(std::vector<size_t> &offsets) { rowOffsets = &offsets; }
+
+  void run(const char *p, size_t n, ScanLevel level = bestScanLevel()) { run(p, 0, n, level); }
+
+  void run(const char *p, size_t begin, size_t end, ScanLevel level)
+  {
+    scan(p, begin, end, level);
+    if (fieldStart < end || cells.size() > rowStart.back())
+    {
+      emit(end);
+      pushRow();
+    }
+  }
+
+  size_t runPartial(const char *p, size_t begin, size_t end, ScanLevel level)
+  {
+    scan(p, begin, end, level);
+    cells.resize(rowStart.back());
+    return recordStart;
+  }
+
+  size_t lastRecordStart() const { return recordStart; }
+
+private:
+  std::vector<CellView> &cells;
+  std::vector<size_t> &rowStart;
+  std::vector<size_t> *rowOffsets = nullptr;
+  size_t recordStart = 0;
+  size_t fieldStart = 0;
+  size_t skipUntil = 0;
+  size_t closeQuote = 0;
+  bool inQuotes = false;
+  bool quoted = false;
+  bool escaped = false;
+
+  void scan(const char *p, size_t begin, size_t end, ScanLevel level)
+  {
+    fieldStart = skipUntil = recordStart = begin;
+    size_t pos = begin;
+    for (; pos + 64 <= end; pos += 64)
+      consume(p, end, pos, structuralMasks(p + pos, level));
+    if (pos < end)
+    {
+      char tail[64] = {0};
+      memcpy(tail, p + pos, end - pos);
+      consume(p, end, pos, structuralMasks(tail, level));
+    }
+  }
+
+  void pushRow()
+  {
+    rowStart.push_back(cells.size());
+    if (rowOffsets)
+      rowOffsets->push_back(recordStart);
+  }
+
+  void emit(size_t end)
+  {
+    if (quoted)
+    {
+      size_t stop = inQuotes ? end : closeQuote;
+      cells.push_back({fieldStart + 1, (uint32_t)(stop - fieldStart - 1), escaped ? 1u : 0u});
+    }
+    else
+    {
+      cells.push_back({fieldStart, (uint32_t)(end - fieldStart), 0});
+    }
+    quoted = escaped = inQuotes = false;
+  }
+
+  void endRecord(size_t pos)
+  {
+    if (pos != fieldStart || cells.size() > rowStart.back())
+    {
+      emit(pos);
+      pushRow();
+    }
+    fieldStart = recordStart = pos + 1;
+  }
+
+  void consume(const char *p, size_t n, size_t base, const StructuralMasks &m)
+  {
+    if (!quoted && !m.quote)
+    {
+      uint64_t mask = m.separator | m.newline;
+      while (mask)
+      {
+        int bit = lowestBit(mask);
+        mask &= mask - 1;
+        size_t pos = base + bit;
+        if ((m.newline >> bit) & 1)
+          endRecord(pos);
+        else
+        {
+          cells.push_back({fieldStart, (uint32_t)(pos - fieldStart), 0});
+          fieldStart = pos + 1;
+        }
+      }
+      return;
+    }
+
+    uint64_t mask = m.separator | m.quote | m.newline;
+    while (mask)
+    {
+      size_t pos = base + lowestBit(mask);
+      mask &= mask - 1;
+      if (pos < skipUntil)
+        continue;
+      char c = p[pos];
+      if (inQuotes)
+      {
+        if (c != '"')
+          continue;
+        if (pos + 1 < n && p[pos + 1] == '"')
+        {
+          escaped = true;
+          skipUntil = pos + 2;
+          continue;
+        }
+        inQuotes = false;
+        closeQuote = pos;
+      }
+      else if (c == '"')
+      {
+        if (pos == fieldStart)
+          inQuotes = quoted = true;
+      }
+      else if (c == ',')
+      {
+        emit(pos);
+        fieldStart = pos + 1;
+      }
+      else
+      {
+        endRecord(pos);
+      }
+    }
+  }
+};
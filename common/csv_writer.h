@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+class CSVFormatter
+{
+public:
+  void cell(std::string_view s)
+  {
+    separate();
+    if (s.find_first_of(",\"\r\n") == std::string_view::npos)
+    {
+      out.append(s.data(), s.size());
+      return;
+    }
+    out.push_back('"');
+    for (char c : s)
+    {
+      if (c == '"')
+        out.push_back('"');
+      out.push_back(c);
+    }
+    out.push_back('"');
+  }
+  void cell(const char *s) { cell(std::string_view(s)); }
+  void cell(const std::string &s) { cell(std::string_view(s)); }
+
+  template <class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  void cell(T value)
+  {
+    separate();
+    text(value);
+  }
+
+  void cell(double value)
+  {
+    separate();
+    appendDouble(value, false, 6);
+  }
+
+  void fixedCell(double value, int precision)
+  {
+    separate();
+    appendDouble(value, true, precision);
+  }
+
+  void text(std::string_view s) { out.append(s.data(), s.size()); }
+
+  template <class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  void text(T value)
+  {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr - buffer);
+  }
+
+  void endRow()
+  {
+    out.push_back('\n');
+    rowStart = true;
+  }
+
+  const std::string &buffer() const { return out; }
+  size_t size() const { return out.size(); }
+
+  void clear()
+  {
+    out.clear();
+    rowStart = true;
+  }
+
+protected:
+  std::string out;
+  bool rowStart = true;
+
+  void separate()
+  {
+    if (!rowStart)
+      out.push_back(',');
+    rowStart = false;
+  }
+
+  void appendDouble(double value, bool fixed, int precision)
+  {
+    char buffer[512];
+#if defined(__cpp_lib_to_chars)
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                fixed ? std::chars_format::fixed : std::chars_format::general, precision);
+    if (result.ec == std::errc())
+    {
+      out.append(buffer, result.ptr - buffer);
+      return;
+    }
+#endif
+    int n = snprintf(buffer, sizeof(buffer), fixed ? "%.*f" : "%.*g", precision, value);
+    if (n >= (int)sizeof(buffer))
+    {
+      std::string wide(n + 1, '\0');
+      snprintf(&wide[0], wide.size(), fixed ? "%.*f" : "%.*g", precision, value);
+      out.append(wide.data(), n);
+    }
+    else if (n > 0)
+      out.append(buffer, n);
+  }
+};
+
+class CSVWriter : public CSVFormatter
+{
+public:
+  explicit CSVWriter(size_t bufferSize = 1 << 20) : capacity(bufferSize) { out.reserve(capacity); }
+  CSVWriter(const CSVWriter &) = delete;
+  CSVWriter &operator=(const CSVWriter &) = delete;
+  ~CSVWriter() { close(); }
+
+  bool open(const std::string &path)
+  {
+    close();
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    failed = fd < 0;
+    written = 0;
+    return fd >= 0;
+  }
+
+  bool close()
+  {
+    if (fd < 0)
+      return !failed;
+    flush();
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+    fd = -1;
+    return !failed;
+  }
+
+  void endRow()
+  {
+    CSVFormatter::endRow();
+    if (out.size() >= capacity)
+      flush();
+  }
+
+  bool flush()
+  {
+    if (!out.empty())
+      writeParts({out});
+    out.clear();
+    return !failed;
+  }
+
+  template <class RowFormatter>
+  void writeRows(size_t rows, int threads, RowFormatter formatRow)
+  {
+    const size_t blockRows = 16384;
+    if (threads > (int)(rows / blockRows))
+      threads = (int)(rows / blockRows);
+    if (threads <= 1)
+    {
+      for (size_t r = 0; r < rows; r++)
+      {
+        formatRow(static_cast<CSVFormatter &>(*this), r);
+        if (out.size() >= capacity)
+          flush();
+      }
+      return;
+    }
+
+    std::vector<CSVFormatter> chunks(threads);
+    for (size_t begin = 0; begin < rows; begin += blockRows * threads)
+    {
+      auto work = [&](int t) {
+        size_t from = begin + t * blockRows, to = std::min(rows, from + blockRows);
+        chunks[t].clear();
+        for (size_t r = from; r < to; r++)
+          formatRow(chunks[t], r);
+      };
+      std::vector<std::thread> workers;
+      for (int t = 1; t < threads; t++)
+        workers.emplace_back(work, t);
+      work(0);
+      for (auto &w : workers)
+        w.join();
+
+      std::vector<std::string_view> parts = {out};
+      for (auto &chunk : chunks)
+        parts.push_back(chunk.buffer());
+      writeParts(parts);
+      out.clear();
+    }
+  }
+
+  size_t bytes() const { return written + out.size(); }
+
+private:
+  int fd = -1;
+  size_t capacity;
+  size_t written = 0;
+  bool failed = false;
+
+  void writeParts(std::vector<std::string_view> parts)
+  {
+    if (fd < 0)
+    {
+      failed = true;
+      return;
+    }
+    size_t next = 0;
+    while (next < parts.size() && !failed)
+    {
+      if (parts[next].empty())
+      {
+        next++;
+        continue;
+      }
+#ifdef _WIN32
+      int n = _write(fd, parts[next].data(), (unsigned)std::min(parts[next].size(), (size_t)1 << 30));
+#else
+      std::vector<iovec> iov;
+      for (size_t i = next; i < parts.size() && iov.size() < 1024; i++)
+        iov.push_back({(void *)parts[i].data(), parts[i].size()});
+      ssize_t n = ::writev(fd, iov.data(), (int)iov.size());
+#endif
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+      {
+        failed = true;
+        return;
+      }
+      written += n;
+      size_t left = (size_t)n;
+      while (next < parts.size() && left >= parts[next].size())
+        left -= parts[next++].size();
+      if (left)
+        parts[next].remove_prefix(left);
+    }
+  }
+};
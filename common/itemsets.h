@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+inline uint64_t hashItemset(const uint32_t *items, size_t n)
+{
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+  for (size_t i = 0; i < n; i++)
+  {
+    h ^= items[i];
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 32;
+  }
+  return h;
+}
+
+class ItemsetIndex
+{
+public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  explicit ItemsetIndex(size_t width = 0) { reset(width); }
+
+  void reset(size_t width, size_t expected = 0)
+  {
+    this->width = width;
+    items.clear();
+    hashes.clear();
+    size_t capacity = 16;
+    while (capacity < expected * 2)
+      capacity <<= 1;
+    slots.assign(capacity, npos);
+  }
+
+  size_t size() const { return hashes.size(); }
+  bool empty() const { return hashes.empty(); }
+  size_t itemsetSize() const { return width; }
+  const uint32_t *operator[](size_t i) const { return items.data() + i * width; }
+  std::vector<uint32_t> itemset(size_t i) const { return std::vector<uint32_t>((*this)[i], (*this)[i] + width); }
+
+  uint32_t find(const uint32_t *itemset) const { return find(itemset, hashItemset(itemset, width)); }
+
+  uint32_t find(const uint32_t *itemset, uint64_t hash) const
+  {
+    for (size_t slot = hash & (slots.size() - 1);; slot = (slot + 1) & (slots.size() - 1))
+    {
+      uint32_t id = slots[slot];
+      if (id == npos || (hashes[id] == hash && same(id, itemset)))
+        return id;
+    }
+  }
+
+  uint32_t insert(const uint32_t *itemset)
+  {
+    uint64_t hash = hashItemset(itemset, width);
+    uint32_t id = find(itemset, hash);
+    if (id != npos)
+      return id;
+    if ((hashes.size() + 1) * 2 > slots.size())
+      grow();
+    id = (uint32_t)hashes.size();
+    items.insert(items.end(), itemset, itemset + width);
+    hashes.push_back(hash);
+    place(id);
+    return id;
+  }
+
+  uint32_t insert(const std::vector<uint32_t> &itemset) { return insert(itemset.data()); }
+  uint32_t find(const std::vector<uint32_t> &itemset) const { return find(itemset.data()); }
+
+private:
+  size_t width = 0;
+  std::vector<uint32_t> items;
+  std::vector<uint64_t> hashes;
+  std::vector<uint32_t> slots;
+
+  bool same(uint32_t id, const uint32_t *itemset) const
+  {
+    const uint32_t *stored = (*this)[id];
+    for (size_t i = 0; i < width; i++)
+      if (stored[i] != itemset[i])
+        return false;
+    return true;
+  }
+
+  void place(uint32_t id)
+  {
+    size_t slot = hashes[id] & (slots.size() - 1);
+    while (slots[slot] != npos)
+      slot = (slot + 1) & (slots.size() - 1);
+    slots[slot] = id;
+  }
+
+  void grow()
+  {
+    slots.assign(slots.size() * 2, npos);
+    for (uint32_t id = 0; id < hashes.size(); id++)
+      place(id);
+  }
+};
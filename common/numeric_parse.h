@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+enum class ParseStatus
+{
+  Ok,
+  Null,
+  Invalid
+};
+
+class NATokens
+{
+public:
+  NATokens() : tokens{"", "N/A", "NA", "-", "null"} {}
+
+  void set(const std::string &list)
+  {
+    tokens.assign(1, "");
+    size_t start = 0;
+    while (start <= list.size())
+    {
+      size_t end = list.find(',', start);
+      if (end == std::string::npos)
+        end = list.size();
+      if (end > start)
+        tokens.push_back(list.substr(start, end - start));
+      start = end + 1;
+    }
+  }
+
+  uint64_t fingerprint() const
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto &t : tokens)
+      for (size_t i = 0; i <= t.size(); i++)
+      {
+        hash ^= i < t.size() ? (unsigned char)t[i] : 0xFFu;
+        hash *= 1099511628211ULL;
+      }
+    return hash;
+  }
+
+  bool contains(std::string_view s) const
+  {
+    for (const auto &t : tokens)
+      if (s == t)
+        return true;
+    return false;
+  }
+
+private:
+  std::vector<std::string> tokens;
+};
+
+inline NATokens &naTokens()
+{
+  static NATokens tokens;
+  return tokens;
+}
+
+inline std::string_view trimNumber(std::string_view s)
+{
+  size_t b = 0, e = s.size();
+  while (b < e && (s[b] == ' ' || s[b] == '\t'))
+    b++;
+  while (e > b && (s[e - 1] == ' ' || s[e - 1] == '\t' || s[e - 1] == '\r' || s[e - 1] == '\n'))
+    e--;
+  return s.substr(b, e - b);
+}
+
+inline ParseStatus parseNumber(std::string_view s, double &out, const NATokens &na = naTokens())
+{
+  s = trimNumber(s);
+  if (na.contains(s))
+    return ParseStatus::Null;
+  if (s.size() > 1 && s[0] == '+' && s[1] != '-' && s[1] != '+')
+    s.remove_prefix(1);
+#if defined(__cpp_lib_to_chars)
+  auto result = std::from_chars(s.data(), s.data() + s.size(), out);
+  if (result.ec != std::errc() || result.ptr != s.data() + s.size())
+    return ParseStatus::Invalid;
+#else
+  char buffer[64];
+  if (s.size() >= sizeof(buffer))
+    return ParseStatus::Invalid;
+  memcpy(buffer, s.data(), s.size());
+  buffer[s.size()] = '\0';
+  char *end = nullptr;
+  out = strtod(buffer, &end);
+  if (end != buffer + s.size())
+    return ParseStatus::Invalid;
+#endif
+  return ParseStatus::Ok;
+}
+
+inline bool parseInteger(std::string_view s, long long &out)
+{
+  s = trimNumber(s);
+  if (s.size() > 1 && s[0] == '+' && s[1] != '-' && s[1] != '+')
+    s.remove_prefix(1);
+  if (s.empty())
+    return false;
+  auto result = std::from_chars(s.data(), s.data() + s.size(), out);
+  return result.ec == std::errc() && result.ptr == s.data() + s.size();
+}
+
+struct ColumnParseStats
+{
+  size_t valid = 0;
+  size_t nulls = 0;
+  size_t invalid = 0;
+
+  ParseStatus record(ParseStatus status)
+  {
+    if (status == ParseStatus::Ok)
+      valid++;
+    else if (status == ParseStatus::Null)
+      nulls++;
+    else
+      invalid++;
+    return status;
+  }
+};
+
+inline void printParseStats(const std::vector<std::string> &names, const std::vector<ColumnParseStats> &stats,
+                            std::ostream &out = std::cerr)
+{
+  for (size_t i = 0; i < stats.size() && i < names.size(); i++)
+    if (stats[i].valid && (stats[i].nulls || stats[i].invalid))
+      out << "Warning: column " << names[i] << " has " << stats[i].nulls << " null and " << stats[i].invalid
+          << " invalid values" << std::endl;
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "categorical.h"
+#include "csv_loader.h"
+#include "numeric_parse.h"
+
+enum class ColumnType
+{
+  Empty,
+  Int,
+  Float,
+  Categorical,
+  Id
+};
+
+inline const char *columnTypeName(ColumnType type)
+{
+  switch (type)
+  {
+  case ColumnType::Int:
+    return "int";
+  case ColumnType::Float:
+    return "float";
+  case ColumnType::Categorical:
+    return "categorical";
+  case ColumnType::Id:
+    return "id";
+  default:
+    return "empty";
+  }
+}
+
+struct ColumnSchema
+{
+  std::string name;
+  ColumnType type = ColumnType::Empty;
+  size_t sampled = 0;
+  size_t nulls = 0;
+  size_t distinct = 0;
+  size_t cardinality = 0;
+
+  bool numeric() const { return type == ColumnType::Int || type == ColumnType::Float; }
+};
+
+struct Schema
+{
+  std::vector<ColumnSchema> columns;
+  size_t sampledRows = 0;
+  size_t totalRows = 0;
+
+  void print(std::ostream &out = std::cout) const
+  {
+    out << "Schema (" << sampledRows << " of " << totalRows << " rows sampled):" << std::endl;
+    for (const auto &column : columns)
+    {
+      out << "  " << column.name << ": " << columnTypeName(column.type);
+      if (column.type == ColumnType::Categorical || column.type == ColumnType::Id)
+        out << " (~" << column.cardinality << " distinct)";
+      out << std::endl;
+    }
+  }
+};
+
+inline std::vector<size_t> sampleRowIndices(size_t rows, size_t sampleRows)
+{
+  std::vector<size_t> indices;
+  size_t count = sampleRows == 0 || rows < sampleRows ? rows : sampleRows;
+  for (size_t i = 0; i < count; i++)
+    indices.push_back(count == rows ? i : i * rows / count);
+  return indices;
+}
+
+inline std::string cellValue(const CSVTable &table, size_t r, size_t c, bool trimmed)
+{
+  if (c >= table.width(r))
+    return std::string();
+  std::string value = table.cellText(r, c);
+  return trimmed ? std::string(trimView(value)) : value;
+}
+
+inline Schema inferSchema(const CSVTable &table, size_t sampleRows = 1024, bool trimmed = false,
+                          const NATokens &na = naTokens())
+{
+  const size_t minIdSample = 16;
+  Schema schema;
+  schema.totalRows = table.rows();
+  std::vector<size_t> sample = sampleRowIndices(table.rows(), sampleRows);
+  schema.sampledRows = sample.size();
+  schema.columns.resize(table.columns());
+
+  for (size_t c = 0; c < schema.columns.size(); c++)
+  {
+    ColumnSchema &column = schema.columns[c];
+    std::string name = table.headerText(c);
+    column.name = trimmed ? std::string(trimView(name)) : name;
+
+    bool numbers = true, integers = true, increasing = true;
+    long long previous = LLONG_MIN;
+    std::unordered_map<std::string, size_t> counts;
+    for (size_t r : sample)
+    {
+      std::string value = cellValue(table, r, c, trimmed);
+      column.sampled++;
+      double number;
+      ParseStatus status = parseNumber(value, number, na);
+      if (status == ParseStatus::Null)
+      {
+        column.nulls++;
+        continue;
+      }
+      counts[value]++;
+      long long integer;
+      if (status == ParseStatus::Invalid)
+        numbers = false;
+      else if (integers && parseInteger(value, integer))
+      {
+        increasing = increasing && integer > previous;
+        previous = integer;
+      }
+      else
+        integers = false;
+    }
+
+    size_t present = column.sampled - column.nulls;
+    size_t singletons = 0;
+    for (const auto &count : counts)
+      singletons += count.second == 1;
+    column.distinct = counts.size();
+    if (present > 0 && singletons == present)
+      column.cardinality = (size_t)std::llround((double)table.rows() * present / column.sampled);
+    else
+    {
+      double scale = sample.empty() ? 1.0 : std::sqrt((double)table.rows() / sample.size());
+      column.cardinality = (size_t)std::llround(scale * singletons) + column.distinct - singletons;
+    }
+    if (column.cardinality > table.rows())
+      column.cardinality = table.rows();
+
+    bool unique = present >= minIdSample && column.distinct == present;
+    if (present == 0)
+      column.type = ColumnType::Empty;
+    else if (numbers && integers)
+      column.type = unique && increasing ? ColumnType::Id : ColumnType::Int;
+    else if (numbers)
+      column.type = ColumnType::Float;
+    else
+      column.type = unique ? ColumnType::Id : ColumnType::Categorical;
+  }
+  return schema;
+}
+
+struct TypedColumn
+{
+  ColumnType type = ColumnType::Empty;
+  std::vector<int64_t> ints;
+  std::vector<double> floats;
+  std::vector<ParseStatus> status;
+  CategoricalColumn categories;
+  ColumnParseStats stats;
+};
+
+class TypedTable
+{
+public:
+  bool load(const CSVTable &table, const Schema &schema, bool trimmed = false, bool fullRowsOnly = false,
+            const NATokens &na = naTokens())
+  {
+    meta = schema;
+    data.assign(meta.columns.size(), TypedColumn());
+    sourceRows.clear();
+    for (size_t c = 0; c < data.size(); c++)
+      data[c].type = meta.columns[c].type;
+
+    for (size_t r = 0; r < table.rows(); r++)
+    {
+      if (fullRowsOnly && table.width(r) != data.size())
+        continue;
+      sourceRows.push_back(r);
+      for (size_t c = 0; c < data.size(); c++)
+        append(table, r, c, trimmed, na);
+    }
+
+    for (size_t c = 0; c < data.size(); c++)
+    {
+      meta.columns[c].type = data[c].type;
+      if (!numeric(c))
+        data[c].categories.sortLevels();
+    }
+    return true;
+  }
+
+  size_t rows() const { return sourceRows.size(); }
+  size_t columns() const { return data.size(); }
+  const Schema &schema() const { return meta; }
+  ColumnType type(size_t c) const { return data[c].type; }
+  bool numeric(size_t c) const { return data[c].type == ColumnType::Int || data[c].type == ColumnType::Float; }
+  const TypedColumn &column(size_t c) const { return data[c]; }
+  const CategoricalColumn &categories(size_t c) const { return data[c].categories; }
+  size_t sourceRow(size_t r) const { return sourceRows[r]; }
+
+  ParseStatus number(size_t r, size_t c, double &out) const
+  {
+    const TypedColumn &column = data[c];
+    if (!numeric(c))
+      return ParseStatus::Invalid;
+    out = column.type == ColumnType::Int ? (double)column.ints[r] : column.floats[r];
+    return column.status[r];
+  }
+
+private:
+  Schema meta;
+  std::vector<TypedColumn> data;
+  std::vector<size_t> sourceRows;
+
+  void append(const CSVTable &table, size_t r, size_t c, bool trimmed, const NATokens &na)
+  {
+    TypedColumn &column = data[c];
+    if (column.type == ColumnType::Int || column.type == ColumnType::Float)
+    {
+      std::string_view raw = c < table.width(r) ? table.cell(r, c) : std::string_view();
+      std::string unescaped;
+      if (c < table.width(r) && table.escaped(r, c))
+        raw = unescaped = table.cellText(r, c);
+
+      long long integer = 0;
+      double number = 0;
+      if (column.type == ColumnType::Int && parseInteger(raw, integer))
+      {
+        column.ints.push_back(integer);
+        column.status.push_back(column.stats.record(ParseStatus::Ok));
+        return;
+      }
+      ParseStatus status = parseNumber(raw, number, na);
+      if (status == ParseStatus::Invalid)
+      {
+        demote(table, c, trimmed);
+        column.categories.codes.push_back(column.categories.dict.intern(cellValue(table, r, c, trimmed)));
+        return;
+      }
+      if (status == ParseStatus::Ok && column.type == ColumnType::Int)
+        promote(c);
+      if (column.type == ColumnType::Int)
+        column.ints.push_back(0);
+      else
+        column.floats.push_back(status == ParseStatus::Ok ? number : 0.0);
+      column.status.push_back(column.stats.record(status));
+      return;
+    }
+
+    if (!trimmed)
+      column.categories.codes.push_back(internCell(column.categories.dict, table, r, c));
+    else
+      column.categories.codes.push_back(column.categories.dict.intern(cellValue(table, r, c, true)));
+  }
+
+  void promote(size_t c)
+  {
+    TypedColumn &column = data[c];
+    column.floats.assign(column.ints.begin(), column.ints.end());
+    column.ints.clear();
+    column.ints.shrink_to_fit();
+    column.type = ColumnType::Float;
+  }
+
+  void demote(const CSVTable &table, size_t c, bool trimmed)
+  {
+    TypedColumn &column = data[c];
+    column.type = ColumnType::Categorical;
+    column.ints.clear();
+    column.floats.clear();
+    column.status.clear();
+    column.stats = ColumnParseStats();
+    for (size_t i = 0; i + 1 < sourceRows.size(); i++)
+      column.categories.codes.push_back(column.categories.dict.intern(cellValue(table, sourceRows[i], c, trimmed)));
+  }
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TIDSET_X86 1
+#include <immintrin.h>
+#endif
+
+enum class PopcountLevel
+{
+  Scalar,
+  Popcnt,
+  AVX2,
+  AVX512
+};
+
+inline const char *popcountLevelName(PopcountLevel level)
+{
+  switch (level)
+  {
+  case PopcountLevel::AVX512:
+    return "AVX-512";
+  case PopcountLevel::AVX2:
+    return "AVX2";
+  case PopcountLevel::Popcnt:
+    return "popcnt";
+  default:
+    return "scalar";
+  }
+}
+
+inline size_t wordBits(uint64_t w)
+{
+#ifdef __GNUC__
+  return (size_t)__builtin_popcountll(w);
+#else
+  size_t count = 0;
+  for (; w; w &= w - 1)
+    count++;
+  return count;
+#endif
+}
+
+inline size_t andCountScalar(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < words; i++)
+  {
+    uint64_t w = a[i] & b[i];
+    out[i] = w;
+    for (; w; w &= w - 1)
+      count++;
+  }
+  return count;
+}
+
+#ifdef TIDSET_X86
+__attribute__((target("popcnt"))) inline size_t andCountPopcnt(const uint64_t *a, const uint64_t *b, uint64_t *out,
+                                                               size_t words)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < words; i++)
+  {
+    out[i] = a[i] & b[i];
+    count += __builtin_popcountll(out[i]);
+  }
+  return count;
+}
+
+__attribute__((target("avx2,popcnt"))) inline size_t andCountAVX2(const uint64_t *a, const uint64_t *b, uint64_t *out,
+                                                                  size_t words)
+{
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2,
+                                          2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0f);
+  __m256i total = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= words; i += 4)
+  {
+    __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                 _mm256_loadu_si256((const __m256i *)(b + i)));
+    _mm256_storeu_si256((__m256i *)(out + i), v);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+                                    _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+  }
+  size_t count = (size_t)_mm256_extract_epi64(total, 0) + (size_t)_mm256_extract_epi64(total, 1) +
+                 (size_t)_mm256_extract_epi64(total, 2) + (size_t)_mm256_extract_epi64(total, 3);
+  return count + andCountPopcnt(a + i, b + i, out + i, words - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt"))) inline size_t andCountAVX512(const uint64_t *a,
+                                                                                      const uint64_t *b,
+                                                                                      uint64_t *out, size_t words)
+{
+  __m512i total = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 8 <= words; i += 8)
+  {
+    __m512i v = _mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    _mm512_storeu_si512(out + i, v);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+  }
+  uint64_t lanes[8];
+  _mm512_storeu_si512(lanes, total);
+  size_t count = 0;
+  for (uint64_t lane : lanes)
+    count += lane;
+  return count + andCountPopcnt(a + i, b + i, out + i, words - i);
+}
+#endif
+
+inline PopcountLevel detectPopcountLevel()
+{
+#ifdef TIDSET_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512vpopcntdq"))
+    return PopcountLevel::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return PopcountLevel::AVX2;
+  if (__builtin_cpu_supports("popcnt"))
+    return PopcountLevel::Popcnt;
+#endif
+  return PopcountLevel::Scalar;
+}
+
+inline PopcountLevel bestPopcountLevel()
+{
+  static const PopcountLevel level = detectPopcountLevel();
+  return level;
+}
+
+inline size_t andCount(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t words,
+                       PopcountLevel level = bestPopcountLevel())
+{
+#ifdef TIDSET_X86
+  if (level == PopcountLevel::AVX512)
+    return andCountAVX512(a, b, out, words);
+  if (level == PopcountLevel::AVX2)
+    return andCountAVX2(a, b, out, words);
+  if (level == PopcountLevel::Popcnt)
+    return andCountPopcnt(a, b, out, words);
+#endif
+  return andCountScalar(a, b, out, words);
+}
+
+inline size_t andCountRange(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t from, size_t to,
+                            PopcountLevel level = bestPopcountLevel())
+{
+  if (from >= to)
+    return 0;
+  size_t first = from / 64, last = (to - 1) / 64;
+  uint64_t head = ~0ULL << (from % 64), tail = ~0ULL >> (63 - (to - 1) % 64);
+  if (first == last)
+  {
+    out[first] = a[first] & b[first];
+    return wordBits(out[first] & head & tail);
+  }
+  out[first] = a[first] & b[first];
+  out[last] = a[last] & b[last];
+  return wordBits(out[first] & head) + wordBits(out[last] & tail) +
+         andCount(a + first + 1, b + first + 1, out + first + 1, last - first - 1, level);
+}
+
+class TidSets
+{
+public:
+  TidSets(size_t transactions = 0) : wordCount((transactions + 63) / 64) {}
+
+  size_t words() const { return wordCount; }
+  size_t size() const { return wordCount ? bits.size() / wordCount : 0; }
+  size_t bytes() const { return bits.size() * sizeof(uint64_t); }
+  const uint64_t *operator[](size_t i) const { return bits.data() + i * wordCount; }
+  uint64_t *operator[](size_t i) { return bits.data() + i * wordCount; }
+
+  uint64_t *add()
+  {
+    bits.resize(bits.size() + wordCount, 0);
+    return bits.data() + bits.size() - wordCount;
+  }
+
+  void set(size_t i, size_t tid) { (*this)[i][tid / 64] |= 1ULL << (tid % 64); }
+  void pop() { bits.resize(bits.size() - wordCount); }
+
+  void clear()
+  {
+    bits.clear();
+    bits.shrink_to_fit();
+  }
+
+private:
+  size_t wordCount;
+  std::vector<uint64_t> bits;
+};
@@ -2,46 +2,44 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <sstream>
 #include <map>
 #include <cmath>
 #include <algorithm>
+#include "../../common/schema.h"
 using namespace std;
 
-vector<vector<string>> data;
+CSVTable table;
+Schema schema;
+TypedTable dataset;
+vector<CategoricalColumn> labels;
 vector<string> headers;
 vector<int> selectedAttributes;
 int targetColumn;
 
-string trim(const string& s) {
-    size_t start = s.find_first_not_of(" \t\r\n");
-    size_t end = s.find_last_not_of(" \t\r\n");
-    return (start == string::npos) ? "" : s.substr(start, end - start + 1);
-}
-
 bool loadCSV(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) return false;
-    
-    string line;
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string h;
-        while (getline(ss, h, ',')) headers.push_back(trim(h));
-    }
+    if (!table.load(filename)) return false;
     
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string cell;
-        vector<string> row;
-        while (getline(ss, cell, ',')) row.push_back(trim(cell));
-        if (row.size() == headers.size()) data.push_back(row);
+    headers = table.headerNames(true);
+    schema = inferSchema(table, 1024, true);
+    
+    size_t records = 0;
+    for (size_t r = 0; r < table.rows(); r++) {
+        if (table.width(r) == headers.size()) records++;
     }
     
-    cout << "Loaded " << data.size() << " records" << endl;
+    cout << "Loaded " << records << " records" << endl;
     return true;
 }
 
+CategoricalColumn textLabels(int col) {
+    CategoricalColumn column;
+    for (size_t r = 0; r < dataset.rows(); r++) {
+        column.codes.push_back(column.dict.intern(cellValue(table, dataset.sourceRow(r), col, true)));
+    }
+    column.sortLevels();
+    return column;
+}
+
 void selectAttributes() {
     cout << "\nAvailable Columns:" << endl;
     for (int i = 0; i < headers.size(); i++)
@@ -59,19 +57,24 @@ void selectAttributes() {
         cout << "Select attribute " << i + 1 << ": ";
         cin >> selectedAttributes[i];
     }
+    
+    schema.columns[targetColumn].type = ColumnType::Categorical;
+    dataset.load(table, schema, true, true);
+    labels.resize(headers.size());
 }
 
 void exploreData() {
     cout << "\nData Exploration" << endl;
     
-    map<string, int> classCount;
-    for (const auto& row : data) {
-        classCount[row[targetColumn]]++;
+    const CategoricalColumn& target = dataset.categories(targetColumn);
+    vector<int> classCount(target.levels(), 0);
+    for (uint32_t code : target.codes) {
+        classCount[code]++;
     }
     
     cout << "Target distribution:" << endl;
-    for (const auto& pair : classCount) {
-        cout << pair.first << ": " << pair.second << " instances" << endl;
+    for (size_t c = 0; c < target.levels(); c++) {
+        cout << target.dict.value(c) << ": " << classCount[c] << " instances" << endl;
     }
 }
 
@@ -80,42 +83,42 @@ void preprocessData() {
     cout << "Converting numerical attributes to categorical" << endl;
     
     for (int col : selectedAttributes) {
-        bool isNumeric = true;
-        vector<double> values;
+        if (!dataset.numeric(col)) {
+            labels[col] = dataset.categories(col);
+            continue;
+        }
+        if (dataset.column(col).stats.valid != dataset.rows()) {
+            labels[col] = textLabels(col);
+            continue;
+        }
         
-        for (const auto& row : data) {
-            try {
-                values.push_back(stod(row[col]));
-            } catch (...) {
-                isNumeric = false;
-                break;
-            }
+        vector<double> values(dataset.rows());
+        for (size_t r = 0; r < dataset.rows(); r++) {
+            dataset.number(r, col, values[r]);
         }
         
-        if (isNumeric && values.size() > 0) {
-            sort(values.begin(), values.end());
-            double median = values[values.size() / 2];
+        if (values.size() > 0) {
+            vector<double> sorted = values;
+            sort(sorted.begin(), sorted.end());
+            double median = sorted[sorted.size() / 2];
             
-            for (auto& row : data) {
-                try {
-                    double val = stod(row[col]);
-                    row[col] = (val <= median) ? "low" : "high";
-                } catch (...) {}
+            for (double val : values) {
+                labels[col].codes.push_back(labels[col].dict.intern((val <= median) ? "low" : "high"));
             }
+            labels[col].sortLevels();
             cout << "Converted " << headers[col] << " to categorical (threshold: " << median << ")" << endl;
         }
     }
 }
 
-double calculateEntropy(const vector<string>& classes) {
-    map<string, int> count;
-    for (const string& cls : classes) count[cls]++;
+double calculateEntropy(const int* count, size_t classes) {
+    int total = 0;
+    for (size_t c = 0; c < classes; c++) total += count[c];
     
     double entropy = 0;
-    int total = classes.size();
     
-    for (const auto& pair : count) {
-        double prob = (double)pair.second / total;
+    for (size_t c = 0; c < classes; c++) {
+        double prob = (double)count[c] / total;
         if (prob > 0) entropy -= prob * log2(prob);
     }
     return entropy;
@@ -124,26 +127,32 @@ double calculateEntropy(const vector<string>& classes) {
 void buildDecisionTree() {
     cout << "\nBuilding Decision Tree" << endl;
     
-    vector<string> allClasses;
-    for (const auto& row : data) {
-        allClasses.push_back(row[targetColumn]);
+    const CategoricalColumn& target = dataset.categories(targetColumn);
+    size_t classes = target.levels();
+    vector<int> allClasses(classes, 0);
+    for (uint32_t code : target.codes) {
+        allClasses[code]++;
     }
     
-    double totalEntropy = calculateEntropy(allClasses);
+    double totalEntropy = calculateEntropy(allClasses.data(), classes);
     cout << "Total entropy: " << totalEntropy << endl;
     
     cout << "Information Gain for each attribute:" << endl;
     
     for (int attr : selectedAttributes) {
-        map<string, vector<string>> subsets;
-        for (const auto& row : data) {
-            subsets[row[attr]].push_back(row[targetColumn]);
+        const CategoricalColumn& values = labels[attr];
+        vector<int> subsets(values.levels() * classes, 0);
+        for (size_t r = 0; r < dataset.rows(); r++) {
+            subsets[values.codes[r] * classes + target.codes[r]]++;
         }
         
         double weightedEntropy = 0;
-        for (const auto& subset : subsets) {
-            double weight = (double)subset.second.size() / data.size();
-            weightedEntropy += weight * calculateEntropy(subset.second);
+        for (size_t v = 0; v < values.levels(); v++) {
+            const int* subset = subsets.data() + v * classes;
+            int size = 0;
+            for (size_t c = 0; c < classes; c++) size += subset[c];
+            double weight = (double)size / dataset.rows();
+            weightedEntropy += weight * calculateEntropy(subset, classes);
         }
         
         double gain = totalEntropy - weightedEntropy;
@@ -3,15 +3,39 @@
 #include <vector>
 #include <string>
 #include <sstream>
-#include <map>
+#include <unordered_map>
+#include <algorithm>
 using namespace std;
 
-vector<vector<string>> data;
+vector<vector<int>> dataset;
+vector<vector<string>> levels;
+vector<unordered_map<string, int>> codes;
+int rows = 0;
 vector<string> headers;
 vector<int> selectedAttributes;
 int targetColumn;
-map<string, int> classFrequency;
-map<string, int> attributeClassFrequency;
+int classLevels = 0;
+vector<int> classFrequency;
+vector<vector<int>> attributeClassFrequency;
+
+int intern(int col, const string& value) {
+    auto it = codes[col].find(value);
+    if (it != codes[col].end()) return it->second;
+    levels[col].push_back(value);
+    return codes[col][value] = levels[col].size() - 1;
+}
+
+int lookup(int col, const string& value) {
+    auto it = codes[col].find(value);
+    return (it == codes[col].end()) ? -1 : it->second;
+}
+
+vector<int> sortedLevels(int col) {
+    vector<int> order(levels[col].size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    sort(order.begin(), order.end(), [&](int a, int b) { return levels[col][a] < levels[col][b]; });
+    return order;
+}
 
 string trim(const string& s) {
     size_t start = s.find_first_not_of(" \t\r\n");
@@ -29,22 +53,27 @@ bool loadCSV(const string& filename) {
         string header;
         while (getline(ss, header, ',')) headers.push_back(trim(header));
     }
+    dataset.resize(headers.size());
+    levels.resize(headers.size());
+    codes.resize(headers.size());
     
     while (getline(file, line)) {
         stringstream ss(line);
         string cell;
         vector<string> row;
         while (getline(ss, cell, ',')) row.push_back(trim(cell));
-        if (row.size() == headers.size()) data.push_back(row);
+        if (row.size() != headers.size()) continue;
+        for (size_t i = 0; i < row.size(); i++) dataset[i].push_back(intern(i, row[i]));
+        rows++;
     }
     
-    cout << "Loaded " << data.size() << " records" << endl;
+    cout << "Loaded " << rows << " records" << endl;
     return true;
 }
 
 void selectAttributes() {
     cout << "\nAttribute Selection:" << endl;
-    for (int i = 0; i < headers.size(); i++) {
+    for (size_t i = 0; i < headers.size(); i++) {
         cout << i << ": " << headers[i] << endl;
     }
     
@@ -65,13 +94,14 @@ void selectAttributes() {
 void exploreData() {
     cout << "\nData Exploration:" << endl;
     
-    for (auto& row : data) {
-        classFrequency[row[targetColumn]]++;
+    classFrequency.assign(levels[targetColumn].size(), 0);
+    for (int code : dataset[targetColumn]) {
+        classFrequency[code]++;
     }
     
     cout << "Class distribution:" << endl;
-    for (auto& pair : classFrequency) {
-        cout << pair.first << ": " << pair.second << " instances" << endl;
+    for (int c : sortedLevels(targetColumn)) {
+        cout << levels[targetColumn][c] << ": " << classFrequency[c] << " instances" << endl;
     }
 }
 
@@ -81,12 +111,17 @@ void preprocessData() {
     
 
     int missingCount = 0;
-    for (auto& row : data) {
-        for (int i = 0; i < row.size(); i++) {
-            if (row[i].empty() || row[i] == "?" || row[i] == "NULL") {
-                row[i] = "unknown";
-                missingCount++;
-            }
+    for (size_t i = 0; i < dataset.size(); i++) {
+        vector<int> remap(levels[i].size());
+        vector<bool> missing(levels[i].size(), false);
+        for (size_t code = 0; code < remap.size(); code++) {
+            const string& value = levels[i][code];
+            missing[code] = value.empty() || value == "?" || value == "NULL";
+            remap[code] = missing[code] ? intern(i, "unknown") : (int)code;
+        }
+        for (int& code : dataset[i]) {
+            if (missing[code]) missingCount++;
+            code = remap[code];
         }
     }
     if (missingCount > 0) {
@@ -94,25 +129,38 @@ void preprocessData() {
     }
     
 
-    for (auto& row : data) {
-        string classVal = row[targetColumn];
+    classLevels = levels[targetColumn].size();
+    attributeClassFrequency.assign(headers.size(), vector<int>());
+    for (int attr : selectedAttributes) {
+        attributeClassFrequency[attr].resize(levels[attr].size() * classLevels, 0);
+    }
+    for (int r = 0; r < rows; r++) {
+        int classVal = dataset[targetColumn][r];
         for (int attr : selectedAttributes) {
-            string key = headers[attr] + ":" + row[attr] + "|" + classVal;
-            attributeClassFrequency[key]++;
+            attributeClassFrequency[attr][dataset[attr][r] * classLevels + classVal]++;
         }
     }
     
-    cout << "Frequency table built with " << attributeClassFrequency.size() << " entries" << endl;
+    int entries = 0;
+    for (auto& table : attributeClassFrequency) {
+        entries += count_if(table.begin(), table.end(), [](int n) { return n > 0; });
+    }
+    cout << "Frequency table built with " << entries << " entries" << endl;
+}
+
+int classCount(int c) {
+    return (c >= 0 && c < (int)classFrequency.size()) ? classFrequency[c] : 0;
 }
 
-double prior(string c) {
-    return (double)classFrequency[c] / data.size();
+double prior(int c) {
+    return (double)classCount(c) / rows;
 }
 
-double conditionalProb(string attr, string val, string c) {
-    string key = attr + ":" + val + "|" + c;
-    int numerator = attributeClassFrequency[key] + 1;
-    int denominator = classFrequency[c] + selectedAttributes.size();
+double conditionalProb(int attr, const string& val, int c) {
+    int v = lookup(attr, val);
+    int count = (v < 0 || c < 0) ? 0 : attributeClassFrequency[attr][v * classLevels + c];
+    int numerator = count + 1;
+    int denominator = classCount(c) + selectedAttributes.size();
     return (double) numerator / denominator;
 }
 
@@ -128,21 +176,26 @@ string classify() {
     }
     
     vector<string> classNames;
-    for (auto& pair : classFrequency) {
-        classNames.push_back(pair.first);
+    vector<int> classCodes;
+    for (int c : sortedLevels(targetColumn)) {
+        if (c >= (int)classFrequency.size()) continue;
+        classNames.push_back(levels[targetColumn][c]);
+        classCodes.push_back(c);
     }
+    int class1 = classCodes[0];
+    int class2 = classCodes[1];
     
-    double prob1 = prior(classNames[0]);
-    double prob2 = prior(classNames[1]);
+    double prob1 = prior(class1);
+    double prob2 = prior(class2);
     
     cout << "\nCalculating probabilities:" << endl;
     cout << "P(" << classNames[0] << ") = " << prob1 << endl;
     cout << "P(" << classNames[1] << ") = " << prob2 << endl;
     
-    for (int i = 0; i < selectedAttributes.size(); i++) {
+    for (size_t i = 0; i < selectedAttributes.size(); i++) {
         int attr = selectedAttributes[i];
-        prob1 *= conditionalProb(headers[attr], testCase[i], classNames[0]);
-        prob2 *= conditionalProb(headers[attr], testCase[i], classNames[1]);
+        prob1 *= conditionalProb(attr, testCase[i], class1);
+        prob2 *= conditionalProb(attr, testCase[i], class2);
     }
     
     cout << "P(" << classNames[0] << "|X) = " << prob1 << endl;
@@ -7,12 +7,14 @@
 #include <set>
 #include <algorithm>
 #include <cctype>
+#include <thread>
 using namespace std;
 
 vector<vector<string>> transactions;
 vector<string> headers;
 double minSupport;
 double minConfidence;
+int numThreads = 1;
 
 string trim(const string& s) {
     size_t start = s.find_first_not_of(" \t\r\n");
@@ -114,23 +116,48 @@ map<string, int> getItemSupport() {
 }
 
 map<set<string>, int> getItemsetSupport(const vector<set<string>>& itemsets) {
-    map<set<string>, int> support;
+    vector<vector<string>> sortedTransactions;
+    for (const auto& transaction : transactions) {
+        set<string> transactionSet(transaction.begin(), transaction.end());
+        sortedTransactions.push_back(vector<string>(transactionSet.begin(), transactionSet.end()));
+    }
     
-    for (const auto& itemset : itemsets) {
-        for (const auto& transaction : transactions) {
-            set<string> transactionSet(transaction.begin(), transaction.end());
-            
-            bool contains = true;
-            for (const string& item : itemset) {
-                if (transactionSet.find(item) == transactionSet.end()) {
-                    contains = false;
-                    break;
+    int threads = max(1, min(numThreads, (int)sortedTransactions.size()));
+    const size_t pad = 64 / sizeof(int);
+    size_t stride = (itemsets.size() + pad - 1) / pad * pad + pad;
+    vector<int> counts(stride * threads, 0);
+    
+    auto countRange = [&](int t) {
+        size_t begin = sortedTransactions.size() * t / threads;
+        size_t end = sortedTransactions.size() * (t + 1) / threads;
+        int* local = counts.data() + stride * t;
+        for (size_t r = begin; r < end; r++) {
+            const vector<string>& transaction = sortedTransactions[r];
+            for (size_t i = 0; i < itemsets.size(); i++) {
+                if (includes(transaction.begin(), transaction.end(), itemsets[i].begin(), itemsets[i].end())) {
+                    local[i]++;
                 }
             }
-            
-            if (contains) {
-                support[itemset]++;
-            }
+        }
+    };
+    
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(countRange, t);
+    }
+    countRange(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    map<set<string>, int> support;
+    for (size_t i = 0; i < itemsets.size(); i++) {
+        int total = 0;
+        for (int t = 0; t < threads; t++) {
+            total += counts[stride * t + i];
+        }
+        if (total > 0) {
+            support[itemsets[i]] = total;
         }
     }
     
@@ -236,12 +263,21 @@ void generateAssociationRules() {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        cout << "Usage: " << argv[0] << " <dataset.csv>" << endl;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            numThreads = max(1, atoi(argv[++i]));
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() != 1) {
+        cout << "Usage: " << argv[0] << " <dataset.csv> [--threads N]" << endl;
         return 1;
     }
     
-    if (!loadCSV(argv[1])) {
+    if (!loadCSV(args[0])) {
         cout << "Failed to load file" << endl;
         return 1;
     }
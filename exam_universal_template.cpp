@@ -14,61 +14,55 @@ RUN: ./exam dataset.csv
 #include <algorithm>
 #include <map>
 #include <iomanip>
+#include "common/schema.h"
 using namespace std;
 
-vector<vector<string>> data;
+vector<vector<string>> dataset;
 vector<string> headers;
 vector<int> selectedCols;
+TypedTable typed;
 
 // 1. DATA LOADING
 bool readCSV(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) return false;
+    CSVTable table;
+    if (!table.load(filename)) return false;
     
-    string line;
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string header;
-        while (getline(ss, header, ',')) {
-            headers.push_back(header);
-        }
-    }
+    headers = table.headerNames();
     
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string cell;
-        vector<string> row;
-        while (getline(ss, cell, ',')) {
-            row.push_back(cell);
-        }
-        if (row.size() == headers.size()) {
-            data.push_back(row);
+    for (size_t r = 0; r < table.rows(); r++) {
+        if (table.width(r) == headers.size()) {
+            dataset.push_back(table.rowText(r));
         }
     }
     
-    file.close();
-    cout << "Loaded " << data.size() << " records, " << headers.size() << " attributes" << endl;
+    // Sample rows to detect column types, then parse once into typed columns
+    Schema schema = inferSchema(table);
+    typed.load(table, schema, false, true);
+    
+    cout << "Loaded " << dataset.size() << " records, " << headers.size() << " attributes" << endl;
+    table.printLoadStats();
+    typed.schema().print();
     return true;
 }
 
 // 2. ATTRIBUTE SELECTION
 void showColumns() {
     cout << "\nAvailable columns:" << endl;
-    for (int i = 0; i < headers.size(); i++) {
+    for (size_t i = 0; i < headers.size(); i++) {
         cout << i << ": " << headers[i] << endl;
     }
 }
 
 void analyzeAttributes() {
     cout << "\n=== ATTRIBUTE ANALYSIS ===" << endl;
-    for (int i = 0; i < headers.size(); i++) {
+    for (size_t i = 0; i < headers.size(); i++) {
         map<string, int> values;
-        for (const auto& row : data) {
+        for (const auto& row : dataset) {
             values[row[i]]++;
         }
         
         cout << headers[i] << ": ";
-        if (values.size() == data.size()) {
+        if (values.size() == dataset.size()) {
             cout << "REMOVE (Unique ID)" << endl;
         } else if (values.size() == 1) {
             cout << "REMOVE (Constant)" << endl;
@@ -99,24 +93,19 @@ vector<int> selectAttributes() {
 // 3. DATA EXPLORATION
 void exploreData() {
     cout << "\n=== DATA EXPLORATION ===" << endl;
-    cout << "Dataset: " << data.size() << " records, " << selectedCols.size() << " selected attributes" << endl;
+    cout << "Dataset: " << dataset.size() << " records, " << selectedCols.size() << " selected attributes" << endl;
     
     for (int col : selectedCols) {
         cout << "\n" << headers[col] << ":" << endl;
         
-        // Try numeric analysis
+        // Numeric analysis for int/float columns
         vector<double> nums;
-        bool isNumeric = true;
-        for (const auto& row : data) {
-            try {
-                nums.push_back(stod(row[col]));
-            } catch (...) {
-                isNumeric = false;
-                break;
-            }
+        for (size_t r = 0; typed.numeric(col) && r < typed.rows(); r++) {
+            double value;
+            if (typed.number(r, col, value) == ParseStatus::Ok) nums.push_back(value);
         }
         
-        if (isNumeric) {
+        if (!nums.empty()) {
             sort(nums.begin(), nums.end());
             double sum = 0;
             for (double x : nums) sum += x;
@@ -126,13 +115,13 @@ void exploreData() {
             cout << "  Min: " << nums[0] << ", Max: " << nums.back() << endl;
             cout << "  Mean: " << fixed << setprecision(2) << mean << endl;
         } else {
-            map<string, int> counts;
-            for (const auto& row : data) {
-                counts[row[col]]++;
-            }
-            cout << "  Type: Categorical (" << counts.size() << " unique values)" << endl;
-            for (const auto& p : counts) {
-                cout << "    " << p.first << ": " << p.second << endl;
+            const CategoricalColumn& values = typed.categories(col);
+            vector<int> counts(values.levels(), 0);
+            for (uint32_t code : values.codes) counts[code]++;
+            cout << "  Type: " << (typed.type(col) == ColumnType::Id ? "ID" : "Categorical")
+                 << " (" << values.levels() << " unique values)" << endl;
+            for (size_t v = 0; v < values.levels(); v++) {
+                cout << "    " << values.dict.value(v) << ": " << counts[v] << endl;
             }
         }
     }
@@ -141,7 +130,7 @@ void exploreData() {
 // 4. PREPROCESSING
 vector<double> getNumericColumn(int col) {
     vector<double> result;
-    for (const auto& row : data) {
+    for (const auto& row : dataset) {
         try {
             result.push_back(stod(row[col]));
         } catch (...) {
@@ -166,17 +155,17 @@ void preprocessData() {
         cout << "Applying Min-Max normalization..." << endl;
         for (int col : selectedCols) {
             try {
-                stod(data[0][col]);
+                if (!typed.numeric(col)) throw invalid_argument(headers[col]);
                 vector<double> vals = getNumericColumn(col);
                 double minVal = *min_element(vals.begin(), vals.end());
                 double maxVal = *max_element(vals.begin(), vals.end());
                 
                 cout << "  " << headers[col] << ": [" << minVal << "," << maxVal << "] -> [0,1]" << endl;
                 
-                for (int i = 0; i < data.size(); i++) {
+                for (size_t i = 0; i < dataset.size(); i++) {
                     if (maxVal != minVal) {
                         double norm = (vals[i] - minVal) / (maxVal - minVal);
-                        data[i][col] = to_string(norm);
+                        dataset[i][col] = to_string(norm);
                     }
                 }
             } catch (...) {
@@ -187,7 +176,7 @@ void preprocessData() {
         cout << "Applying Z-Score standardization..." << endl;
         for (int col : selectedCols) {
             try {
-                stod(data[0][col]);
+                if (!typed.numeric(col)) throw invalid_argument(headers[col]);
                 vector<double> vals = getNumericColumn(col);
                 double sum = 0;
                 for (double x : vals) sum += x;
@@ -199,10 +188,10 @@ void preprocessData() {
                 
                 cout << "  " << headers[col] << ": mean=" << mean << ", std=" << stdDev << endl;
                 
-                for (int i = 0; i < data.size(); i++) {
+                for (size_t i = 0; i < dataset.size(); i++) {
                     if (stdDev != 0) {
                         double zscore = (vals[i] - mean) / stdDev;
-                        data[i][col] = to_string(zscore);
+                        dataset[i][col] = to_string(zscore);
                     }
                 }
             } catch (...) {
@@ -213,7 +202,7 @@ void preprocessData() {
         cout << "Handling missing values..." << endl;
         for (int col : selectedCols) {
             int missing = 0;
-            for (const auto& row : data) {
+            for (const auto& row : dataset) {
                 if (row[col].empty() || row[col] == "?" || row[col] == "NA") {
                     missing++;
                 }
@@ -222,7 +211,7 @@ void preprocessData() {
                 cout << "  " << headers[col] << ": Found " << missing << " missing values" << endl;
                 // Replace with most frequent value for simplicity
                 map<string, int> counts;
-                for (const auto& row : data) {
+                for (const auto& row : dataset) {
                     if (!row[col].empty() && row[col] != "?" && row[col] != "NA") {
                         counts[row[col]]++;
                     }
@@ -234,7 +223,7 @@ void preprocessData() {
                     }
                 }
                 
-                for (auto& row : data) {
+                for (auto& row : dataset) {
                     if (row[col].empty() || row[col] == "?" || row[col] == "NA") {
                         row[col] = mostFrequent;
                     }
@@ -257,7 +246,7 @@ void applyMethod() {
     cin >> choice;
     
     cout << "\n// INSERT YOUR ALGORITHM HERE //" << endl;
-    cout << "// Available data: data[row][col] //" << endl;
+    cout << "// Available data: dataset[row][col] //" << endl;
     cout << "// Selected columns: selectedCols vector //" << endl;
     cout << "// Use getNumericColumn(col) for calculations //" << endl;
     
@@ -280,14 +269,14 @@ void applyMethod() {
 // 6. SAVE RESULTS
 void saveResults() {
     ofstream file("output.csv");
-    for (int i = 0; i < headers.size(); i++) {
+    for (size_t i = 0; i < headers.size(); i++) {
         file << headers[i];
         if (i < headers.size() - 1) file << ",";
     }
     file << endl;
     
-    for (const auto& row : data) {
-        for (int i = 0; i < row.size(); i++) {
+    for (const auto& row : dataset) {
+        for (size_t i = 0; i < row.size(); i++) {
             file << row[i];
             if (i < row.size() - 1) file << ",";
         }
@@ -3,52 +3,44 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include "common/csv_loader.h"
+#include "common/numeric_parse.h"
+#include "common/csv_writer.h"
 using namespace std;
 
 // Universal data structure
-vector<vector<double>> data;
+vector<vector<double>> dataset;
 vector<string> headers;
 
 // Universal CSV reader - MEMORIZE THIS!
 bool readCSV(string filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
+    CSVTable table;
+    if (!table.load(filename)) {
         cout << "Error opening file!" << endl;
         return false;
     }
     
-    string line;
-    
     // Read headers
-    if (getline(file, line)) {
-        stringstream ss(line);
-        string header;
-        while (getline(ss, header, ',')) {
-            headers.push_back(header);
-        }
-    }
+    headers = table.headerNames();
     
     // Read data rows
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string cell;
-        vector<double> row;
-        
-        while (getline(ss, cell, ',')) {
-            try {
-                row.push_back(stod(cell)); // Convert to double
-            } catch (...) {
-                row.push_back(0); // Default for non-numeric
-            }   
-        }
+    vector<ColumnParseStats> stats(headers.size());
+    for (size_t r = 0; r < table.rows(); r++) {
+        if (table.width(r) != headers.size()) continue;
         
-        if (row.size() == headers.size()) {
-            data.push_back(row);
+        vector<double> row;
+        for (size_t c = 0; c < headers.size(); c++) {
+            double value;
+            if (stats[c].record(parseNumber(table.cell(r, c), value)) != ParseStatus::Ok)
+                value = 0; // Default for non-numeric
+            row.push_back(value);
         }
+        dataset.push_back(row);
     }
     
-    file.close();
-    cout << "Loaded " << data.size() << " records with " << headers.size() << " columns" << endl;
+    cout << "Loaded " << dataset.size() << " records with " << headers.size() << " columns" << endl;
+    printParseStats(headers, stats);
+    table.printLoadStats();
     return true;
 }
 
@@ -81,22 +73,17 @@ vector<int> selectColumns() {
 
 // Save results to CSV - MEMORIZE THIS!
 void saveCSV(string filename, vector<string> resultHeaders, vector<vector<string>> results) {
-    ofstream file(filename);
+    CSVWriter file;
+    file.open(filename);
     
     // Write headers
-    for (int i = 0; i < resultHeaders.size(); i++) {
-        file << resultHeaders[i];
-        if (i < resultHeaders.size() - 1) file << ",";  
-    }
-    file << endl;
+    for (auto& header : resultHeaders) file.cell(header);
+    file.endRow();
     
     // Write data
     for (auto& row : results) {
-        for (int i = 0; i < row.size(); i++) {
-            file << row[i];
-            if (i < row.size() - 1) file << ",";
-        }
-        file << endl;
+        for (auto& value : row) file.cell(value);
+        file.endRow();
     }
     
     file.close();
@@ -123,10 +110,10 @@ int main(int argc, char* argv[]) {
     
     // Example: Print selected data
     cout << "Selected data:" << endl;
-    for (int i = 0; i < min(5, (int)data.size()); i++) {
+    for (int i = 0; i < min(5, (int)dataset.size()); i++) {
         cout << "Row " << i << ": ";
         for (int col : cols) {
-            cout << data[i][col] << " ";
+            cout << dataset[i][col] << " ";
         }
         cout << endl;
     }
@@ -152,7 +139,7 @@ MEMORIZE THESE 4 FUNCTIONS:
 USAGE FOR ANY ALGORITHM:
 1. Call readCSV() to load data
 2. Call selectColumns() if you need specific columns
-3. Access data with: data[row][col]
+3. Access data with: dataset[row][col]
 4. Call saveCSV() to save results
 
 WORKS FOR ALL 14 QUESTIONS!
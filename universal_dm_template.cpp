@@ -6,10 +6,12 @@
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
+#include "common/csv_loader.h"
+#include "common/numeric_parse.h"
 using namespace std;
 
 // Global variables - easy to remember
-vector<vector<double>> data;
+vector<vector<double>> dataset;
 vector<string> headers;
 vector<int> selectedCols;
 
@@ -32,7 +34,7 @@ void step1_attributeSelection() {
     cout << "\n=== STEP 1: ATTRIBUTE SELECTION ===" << endl;
     
     cout << "Available columns:" << endl;
-    for(int i = 0; i < headers.size(); i++) {
+    for(size_t i = 0; i < headers.size(); i++) {
         cout << i << ": " << headers[i] << endl;
     }
     
@@ -59,13 +61,13 @@ void step1_attributeSelection() {
 void step2_dataExploration() {
     cout << "\n=== STEP 2: DATA EXPLORATION ===" << endl;
     
-    cout << "Dataset: " << data.size() << " records, " 
+    cout << "Dataset: " << dataset.size() << " records, " 
          << selectedCols.size() << " attributes" << endl;
     
     for(int col : selectedCols) {
         vector<double> values;
-        for(int i = 0; i < data.size(); i++) {
-            values.push_back(data[i][col]);
+        for(size_t i = 0; i < dataset.size(); i++) {
+            values.push_back(dataset[i][col]);
         }
         
         sort(values.begin(), values.end());
@@ -95,19 +97,19 @@ void step3_preprocessing() {
         cout << "Applying Min-Max normalization..." << endl;
         
         for(int col : selectedCols) {
-            double minVal = data[0][col];
-            double maxVal = data[0][col];
+            double minVal = dataset[0][col];
+            double maxVal = dataset[0][col];
             
             // Find min and max
-            for(int i = 0; i < data.size(); i++) {
-                minVal = min(minVal, data[i][col]);
-                maxVal = max(maxVal, data[i][col]);
+            for(size_t i = 0; i < dataset.size(); i++) {
+                minVal = min(minVal, dataset[i][col]);
+                maxVal = max(maxVal, dataset[i][col]);
             }
             
             // Normalize
-            for(int i = 0; i < data.size(); i++) {
+            for(size_t i = 0; i < dataset.size(); i++) {
                 if(maxVal != minVal) {
-                    data[i][col] = (data[i][col] - minVal) / (maxVal - minVal);
+                    dataset[i][col] = (dataset[i][col] - minVal) / (maxVal - minVal);
                 }
             }
             
@@ -116,10 +118,10 @@ void step3_preprocessing() {
     }
     
     cout << "First 3 records after preprocessing:" << endl;
-    for(int i = 0; i < min(3, (int)data.size()); i++) {
+    for(int i = 0; i < min(3, (int)dataset.size()); i++) {
         cout << "Record " << i << ": ";
         for(int col : selectedCols) {
-            cout << fixed << setprecision(3) << data[i][col] << " ";
+            cout << fixed << setprecision(3) << dataset[i][col] << " ";
         }
         cout << endl;
     }
@@ -136,49 +138,39 @@ void step4_applyMethod() {
     cout << "d) Prediction" << endl;
     
     cout << "\n// INSERT YOUR ALGORITHM HERE //" << endl;
-    cout << "// Use: data[i][selectedCols[j]] to access processed data //" << endl;
+    cout << "// Use: dataset[i][selectedCols[j]] to access processed data //" << endl;
     cout << "// Example: K-means, DBSCAN, Naive Bayes, etc. //" << endl;
 }
 
 // Load CSV data
 bool loadData(string filename) {
-    ifstream file(filename);
-    if(!file.is_open()) {
+    CSVTable table;
+    if(!table.load(filename)) {
         cout << "Error opening file!" << endl;
         return false;
     }
     
-    string line;
-    
     // Read headers
-    if(getline(file, line)) {
-        stringstream ss(line);
-        string header;
-        while(getline(ss, header, ',')) {
-            headers.push_back(header);
-        }
-    }
+    headers = table.headerNames();
     
     // Read data
-    while(getline(file, line)) {
-        stringstream ss(line);
-        string cell;
-        vector<double> row;
+    vector<ColumnParseStats> stats(headers.size());
+    for(size_t r = 0; r < table.rows(); r++) {
+        if(table.width(r) != headers.size()) continue;
         
-        while(getline(ss, cell, ',')) {
-            try {
-                row.push_back(stod(cell));
-            } catch(...) {
-                row.push_back(0); // Default for non-numeric
-            }
-        }
-        
-        if(row.size() == headers.size()) {
-            data.push_back(row);
+        vector<double> row;
+        for(size_t c = 0; c < headers.size(); c++) {
+            double value;
+            if(stats[c].record(parseNumber(table.cell(r, c), value)) != ParseStatus::Ok)
+                value = 0; // Default for non-numeric
+            row.push_back(value);
         }
+        dataset.push_back(row);
     }
     
-    cout << "Loaded " << data.size() << " records" << endl;
+    cout << "Loaded " << dataset.size() << " records" << endl;
+    printParseStats(headers, stats);
+    table.printLoadStats();
     return true;
 }
 